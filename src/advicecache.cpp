@@ -0,0 +1,124 @@
+#include "advicecache.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include "logger.h"
+
+AdviceCache::AdviceCache(int memoryCapacity, qint64 diskCapacity)
+    : m_memory(memoryCapacity)
+    , m_diskCapacity(diskCapacity)
+{
+    m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/advice";
+    QDir().mkpath(m_directory);
+    trimDisk();
+}
+
+QByteArray AdviceCache::makeKey(const QByteArray &canonicalState)
+{
+    return QCryptographicHash::hash(canonicalState, QCryptographicHash::Sha256).toHex();
+}
+
+bool AdviceCache::lookup(const QByteArray &key, QString *advice)
+{
+    ++m_stats.lookups;
+
+    if (QString *cached = m_memory.object(key)) {
+        ++m_stats.memoryHits;
+        *advice = *cached;
+        return true;
+    }
+
+    QFile file(filePath(key));
+    if (file.open(QIODevice::ReadOnly)) {
+        QString stored = QString::fromUtf8(file.readAll());
+        if (!stored.isEmpty()) {
+            ++m_stats.diskHits;
+            m_memory.insert(key, new QString(stored));
+            *advice = stored;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool AdviceCache::contains(const QByteArray &key) const
+{
+    return m_memory.contains(key) || QFile::exists(filePath(key));
+}
+
+void AdviceCache::insert(const QByteArray &key, const QString &advice)
+{
+    if (key.isEmpty() || advice.isEmpty()) {
+        return;
+    }
+
+    m_memory.insert(key, new QString(advice));
+
+    QFile file(filePath(key));
+    const qint64 previousSize = file.exists() ? file.size() : 0;
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        const qint64 written = file.write(advice.toUtf8());
+        if (written >= 0) {
+            m_diskBytes += written - previousSize;
+        }
+    } else {
+        logDebug(lcDecision) << "Failed to write advice cache file:" << file.fileName();
+    }
+    if (m_diskBytes > m_diskCapacity) {
+        file.close();
+        trimDisk();
+    }
+}
+
+void AdviceCache::clear()
+{
+    m_memory.clear();
+    QDir dir(m_directory);
+    for (const QString &name : dir.entryList({"*.txt"}, QDir::Files)) {
+        dir.remove(name);
+    }
+    m_diskBytes = 0;
+    m_stats = Stats();
+}
+
+const AdviceCache::Stats &AdviceCache::stats() const
+{
+    return m_stats;
+}
+
+QString AdviceCache::filePath(const QByteArray &key) const
+{
+    return QString("%1/%2.txt").arg(m_directory, QString::fromLatin1(key));
+}
+
+void AdviceCache::trimDisk()
+{
+    // 超出限额时按修改时间从旧到新删到限额的3/4，留出余量，避免之后每次写入都重新扫描目录；
+    // 被删条目若仍在内存层中，本次运行内照常命中
+    QDir dir(m_directory);
+    const QFileInfoList files = dir.entryInfoList({"*.txt"}, QDir::Files, QDir::Time | QDir::Reversed);
+    m_diskBytes = 0;
+    for (const QFileInfo &info : files) {
+        m_diskBytes += info.size();
+    }
+    if (m_diskBytes <= m_diskCapacity) {
+        return;
+    }
+    const qint64 target = m_diskCapacity / 4 * 3;
+    int removed = 0;
+    for (const QFileInfo &info : files) {
+        if (m_diskBytes <= target) {
+            break;
+        }
+        if (dir.remove(info.fileName())) {
+            m_diskBytes -= info.size();
+            ++removed;
+        }
+    }
+    if (removed > 0) {
+        logDebug(lcDecision) << "Advice cache evicted" << removed << "files, disk size now" << m_diskBytes << "bytes";
+    }
+}
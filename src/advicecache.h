@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QByteArray>
+#include <QCache>
+#include <QString>
+
+// AI建议的两级缓存：内存LRU + 磁盘存储，键为规范化局面描述的哈希。
+// 磁盘层按总字节数限额，超出时按修改时间删除最早写入的文件（启动时与写入时检查）
+class AdviceCache {
+public:
+    struct Stats {
+        quint64 lookups = 0;
+        quint64 memoryHits = 0;
+        quint64 diskHits = 0;
+
+        quint64 hits() const { return memoryHits + diskHits; }
+        double hitRate() const { return lookups > 0 ? static_cast<double>(hits()) / lookups : 0.0; }
+    };
+
+    static constexpr qint64 DEFAULT_DISK_CAPACITY = 8 * 1024 * 1024;
+
+    // memoryCapacity为内存中的条目数，diskCapacity为磁盘文件总字节数
+    explicit AdviceCache(int memoryCapacity = 128, qint64 diskCapacity = DEFAULT_DISK_CAPACITY);
+
+    // 由规范化局面描述生成内容寻址的键（SHA-256十六进制）
+    static QByteArray makeKey(const QByteArray &canonicalState);
+
+    bool lookup(const QByteArray &key, QString *advice);
+    bool contains(const QByteArray &key) const; // 不计入命中统计
+    void insert(const QByteArray &key, const QString &advice);
+    void clear();
+
+    const Stats &stats() const;
+
+private:
+    QString filePath(const QByteArray &key) const;
+    // 重新统计磁盘层大小，超出限额时删除最旧的文件
+    void trimDisk();
+
+    QCache<QByteArray, QString> m_memory;
+    QString m_directory;
+    qint64 m_diskCapacity;
+    qint64 m_diskBytes = 0;
+    Stats m_stats;
+};
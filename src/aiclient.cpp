@@ -4,36 +4,116 @@
 #include <QSslConfiguration>
 #include <QSslSocket>
 #include <QDebug>
+#include <QDateTime>
+#include <QLocale>
+#include <QRandomGenerator>
+#include <QtMath>
+#include <algorithm>
+#include <atomic>
+#include "logger.h"
+#include "tracer.h"
+
+namespace {
+// 所有AIClient共享同一份每分钟请求预算
+struct RequestBucket {
+    int requestsPerMinute = 0;
+    double capacity = 0;
+    double refillPerMs = 0;
+    double tokens = 0;
+    QElapsedTimer refillTimer;
+};
+
+RequestBucket &requestBucket()
+{
+    static RequestBucket bucket;
+    return bucket;
+}
+
+// 追踪中异步区间的ID需在所有客户端和线程间唯一
+std::atomic<quint64> g_nextRequestSerial{0};
+}
 
 AIClient::AIClient(QObject *parent)
     : QObject(parent)
     , m_networkManager(new QNetworkAccessManager(this))
     , m_currentReply(nullptr)
+    , m_hedgeReply(nullptr)
     , m_timeoutTimer(new QTimer(this))
+    , m_hedgeTimer(new QTimer(this))
+    , m_retryTimer(new QTimer(this))
+    , m_requestSerial(0)
     , m_model("gpt-3.5-turbo")  // 初始化默认模型
+    , m_priority(QNetworkRequest::NormalPriority)
+    , m_toolRounds(0)
+    , m_hedgingEnabled(false)
+    , m_hedgePercentile(90)
+    , m_maxRetries(3)
+    , m_attempt(0)
+    , m_timedOut(false)
+    , m_requestTimeoutMs(REQUEST_TIMEOUT_MS)
+    , m_streaming(false)
+    , m_streamDone(false)
 {
     
+    qRegisterMetaType<RequestMetrics>();
+    
     m_timeoutTimer->setSingleShot(true);
     connect(m_timeoutTimer, &QTimer::timeout, this, &AIClient::onRequestTimeout);
+    m_hedgeTimer->setSingleShot(true);
+    connect(m_hedgeTimer, &QTimer::timeout, this, &AIClient::onHedgeTimeout);
+    m_retryTimer->setSingleShot(true);
+    connect(m_retryTimer, &QTimer::timeout, this, &AIClient::startAttempt);
     
     // 检查SSL支持
     bool sslSupported = QSslSocket::supportsSsl();
-    qDebug() << "SSL Support:" << sslSupported;
-    qDebug() << "SSL Library Build Version:" << QSslSocket::sslLibraryBuildVersionString();
-    qDebug() << "SSL Library Runtime Version:" << QSslSocket::sslLibraryVersionString();
+    logDebug(lcAI) << "SSL Support:" << sslSupported;
+    logDebug(lcAI) << "SSL Library Build Version:" << QSslSocket::sslLibraryBuildVersionString();
+    logDebug(lcAI) << "SSL Library Runtime Version:" << QSslSocket::sslLibraryVersionString();
     
     if (!sslSupported) {
-        qDebug() << "Warning: SSL not supported. HTTPS requests may fail.";
-        qDebug() << "Consider using HTTP endpoints or install SSL libraries.";
+        logWarning(lcAI) << "SSL not supported. HTTPS requests may fail.";
+        logWarning(lcAI) << "Consider using HTTP endpoints or install SSL libraries.";
     } else {
         // 只有在SSL支持时才配置SSL
-        QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
-        sslConfig.setPeerVerifyMode(QSslSocket::VerifyNone);
-        sslConfig.setProtocol(QSsl::TlsV1_2OrLater);
-        QSslConfiguration::setDefaultConfiguration(sslConfig);
+        QSslConfiguration::setDefaultConfiguration(sslConfiguration());
     }
 }
 
+QSslConfiguration AIClient::sslConfiguration()
+{
+    // 预热连接和实际请求必须使用相同的SSL配置，QNetworkAccessManager才会复用连接
+    QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
+    sslConfig.setPeerVerifyMode(QSslSocket::VerifyNone);
+    sslConfig.setProtocol(QSsl::TlsV1_2OrLater);
+    // 通过ALPN优先协商HTTP/2，不支持时回退到HTTP/1.1
+    sslConfig.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2,
+                                       QSslConfiguration::NextProtocolHttp1_1});
+    return sslConfig;
+}
+
+void AIClient::warmUpConnection()
+{
+    QUrl url(m_apiUrl);
+    if (!url.isValid() || url.host().isEmpty()) {
+        return;
+    }
+    
+    const bool https = url.scheme().toLower() == "https";
+    const int port = url.port(https ? 443 : 80);
+    
+    if (https && QSslSocket::supportsSsl()) {
+        m_networkManager->connectToHostEncrypted(url.host(), port, sslConfiguration());
+    } else if (!https) {
+        m_networkManager->connectToHost(url.host(), port);
+    } else {
+        return;
+    }
+    
+    m_warmHost = QString("%1://%2:%3").arg(url.scheme().toLower(), url.host()).arg(port);
+    m_warmTimer.start();
+    logDebug(lcAI) << "Warming up connection to" << m_warmHost;
+}
+
 void AIClient::setApiUrl(const QString &url)
 {
     m_apiUrl = url;
@@ -48,122 +128,569 @@ void AIClient::setModel(const QString &model)
 {
     QString oldModel = m_model;
     m_model = model.isEmpty() ? "gpt-3.5-turbo" : model;
-    qDebug() << "=== AIClient Model Changed ===";
-    qDebug() << "Old Model:" << oldModel;
-    qDebug() << "New Model:" << m_model;
-    qDebug() << "Input Model:" << model;
+    logDebug(lcAI) << "=== AIClient Model Changed ===";
+    logDebug(lcAI) << "Old Model:" << oldModel;
+    logDebug(lcAI) << "New Model:" << m_model;
+    logDebug(lcAI) << "Input Model:" << model;
+}
+
+void AIClient::setStreaming(bool enabled)
+{
+    m_streaming = enabled;
+}
+
+void AIClient::setBackupEndpoints(const QList<Endpoint> &endpoints)
+{
+    m_backupEndpoints = endpoints;
+}
+
+void AIClient::setHedging(bool enabled, int percentile)
+{
+    m_hedgingEnabled = enabled;
+    m_hedgePercentile = qBound(50, percentile, 99);
+}
+
+void AIClient::setMaxRetries(int maxRetries)
+{
+    m_maxRetries = qMax(0, maxRetries);
+}
+
+void AIClient::setRequestTimeout(int timeoutMs)
+{
+    m_requestTimeoutMs = timeoutMs > 0 ? timeoutMs : REQUEST_TIMEOUT_MS;
+}
+
+void AIClient::setRequestsPerMinute(int requestsPerMinute)
+{
+    // 桶容量允许少量突发，补充速率扣除容量，使任意一分钟内的请求数不超过上限
+    RequestBucket &bucket = requestBucket();
+    bucket.requestsPerMinute = qMax(0, requestsPerMinute);
+    bucket.capacity = qMax(1, bucket.requestsPerMinute / 4);
+    bucket.refillPerMs = qMax(1.0, bucket.requestsPerMinute - bucket.capacity) / 60000.0;
+    bucket.tokens = bucket.capacity;
+    bucket.refillTimer.start();
+}
+
+int AIClient::acquireRequestToken()
+{
+    RequestBucket &bucket = requestBucket();
+    if (bucket.requestsPerMinute <= 0) {
+        return 0;
+    }
+    
+    bucket.tokens = qMin(bucket.capacity, bucket.tokens + bucket.refillTimer.restart() * bucket.refillPerMs);
+    if (bucket.tokens >= 1.0) {
+        bucket.tokens -= 1.0;
+        return 0;
+    }
+    return qMax(1, qCeil((1.0 - bucket.tokens) / bucket.refillPerMs));
+}
+
+void AIClient::setPriority(QNetworkRequest::Priority priority)
+{
+    m_priority = priority;
+}
+
+void AIClient::setTools(const QList<Tool> &tools)
+{
+    m_tools = tools;
 }
 
 void AIClient::sendRequest(const QString &systemPrompt, const QString &userPrompt)
 {
-    if (m_currentReply) {
+    sendRequest(systemPrompt, QJsonArray(), userPrompt);
+}
+
+void AIClient::sendRequest(const QString &systemPrompt, const QJsonArray &history, const QString &userPrompt)
+{
+    TRACE_SCOPE("AIClient::sendRequest");
+    
+    if (isBusy()) {
         cancelRequest();
     }
     
-    qDebug() << "=== AI Client Request Start ===";
-    qDebug() << "API URL:" << m_apiUrl;
-    qDebug() << "API Key:" << (m_apiKey.isEmpty() ? "Empty" : QString("***...%1").arg(m_apiKey.right(4)));
+    logDebug(lcAI) << "=== AI Client Request Start ===";
+    logDebug(lcAI) << "API URL:" << m_apiUrl;
+    logDebug(lcAI) << "API Key:" << (m_apiKey.isEmpty() ? "Empty" : QString("***...%1").arg(m_apiKey.right(4)));
+    logTrace(lcAI) << "System Prompt:" << systemPrompt;
+    logTrace(lcAI) << "User Prompt:" << userPrompt;
+    logDebug(lcAI) << "History Messages:" << history.size();
     
-    QUrl url(m_apiUrl);
+    m_messages = QJsonArray{QJsonObject{{"role", "system"}, {"content", systemPrompt}}};
+    for (const QJsonValue &message : history) {
+        m_messages.append(message);
+    }
+    m_messages.append(QJsonObject{{"role", "user"}, {"content", userPrompt}});
+    m_toolRounds = 0;
+    m_attempt = 0;
+    
+    m_metrics = RequestMetrics();
+    m_metrics.startedAt = QDateTime::currentDateTime();
+    m_metrics.endpoint = m_apiUrl;
+    m_metrics.model = m_model;
+    m_metrics.streamed = m_streaming;
+    m_totalTimer.start();
+    
+    emit requestStarted();
+    m_requestSerial = ++g_nextRequestSerial;
+    TRACE_ASYNC_BEGIN("AI request", m_requestSerial);
+    startAttempt();
+}
+
+void AIClient::startAttempt()
+{
+    // 超出每分钟请求预算时推迟发送，等待不计入重试次数
+    int waitMs = acquireRequestToken();
+    if (waitMs > 0) {
+        logDebug(lcAI) << "Request budget exhausted, waiting" << waitMs << "ms";
+        emit requestThrottled(waitMs);
+        m_retryTimer->start(waitMs);
+        return;
+    }
+    
+    ++m_attempt;
+    m_timedOut = false;
+    m_streamBuffer.clear();
+    m_streamRawBody.clear();
+    m_streamContent.clear();
+    m_streamReasoning.clear();
+    m_streamToolCalls = QJsonArray();
+    m_streamDone = false;
+    
+    m_metrics.queueMs = m_totalTimer.elapsed();
+    m_requestTimer.start();
+    m_currentReply = postToEndpoint({m_apiUrl, m_apiKey, m_model});
+    
+    // 备用端点在主端点迟迟无响应时发出对冲请求
+    if (m_hedgingEnabled && !m_backupEndpoints.isEmpty()) {
+        int delay = hedgeDelayMs();
+        logDebug(lcAI) << "Hedge request scheduled after" << delay << "ms";
+        m_hedgeTimer->start(delay);
+    }
+    
+    // 启动超时计时器
+    m_timeoutTimer->start(m_requestTimeoutMs);
+    logDebug(lcAI) << "Attempt" << m_attempt << "sent, waiting for response...";
+}
+
+int AIClient::estimateTokens(const QString &text)
+{
+    int tokens = 0;
+    int asciiRun = 0;
+    for (const QChar ch : text) {
+        const ushort code = ch.unicode();
+        if (code < 0x80) {
+            if (ch.isLetterOrNumber()) {
+                ++asciiRun;
+                continue;
+            }
+            tokens += (asciiRun + 3) / 4;
+            asciiRun = 0;
+            if (!ch.isSpace()) {
+                ++tokens; // 标点符号通常单独成token
+            }
+        } else {
+            tokens += (asciiRun + 3) / 4;
+            asciiRun = 0;
+            if (!ch.isLowSurrogate()) {
+                ++tokens;
+            }
+        }
+    }
+    return tokens + (asciiRun + 3) / 4;
+}
+
+int AIClient::estimatePromptTokens(const QString &systemPrompt, const QString &userPrompt)
+{
+    // 每条消息另有约4个token的角色和分隔开销
+    return estimateTokens(systemPrompt) + estimateTokens(userPrompt) + 2 * 4;
+}
+
+int AIClient::estimateHistoryTokens(const QJsonArray &history)
+{
+    int tokens = 0;
+    for (const QJsonValue &message : history) {
+        tokens += estimateTokens(message.toObject()["content"].toString()) + 4;
+    }
+    return tokens;
+}
+
+bool AIClient::isBusy() const
+{
+    return m_currentReply || m_retryTimer->isActive();
+}
+
+QNetworkReply *AIClient::postToEndpoint(const Endpoint &endpoint)
+{
+    QUrl url(endpoint.url);
     QNetworkRequest request(url);
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
-    request.setRawHeader("Authorization", QString("Bearer %1").arg(m_apiKey).toUtf8());
+    request.setRawHeader("Authorization", QString("Bearer %1").arg(endpoint.apiKey).toUtf8());
+    if (m_streaming) {
+        request.setRawHeader("Accept", "text/event-stream");
+    }
+    
+    // 保持长连接并允许HTTP/2，连续请求无需重新握手
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    request.setPriority(m_priority);
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    request.setAttribute(QNetworkRequest::ConnectionCacheExpiryTimeoutSecondsAttribute, KEEP_ALIVE_SECONDS);
+#endif
     
     // 只有在SSL支持且是HTTPS时才配置SSL设置
     if (QSslSocket::supportsSsl() && url.scheme().toLower() == "https") {
-        QSslConfiguration sslConfig = request.sslConfiguration();
-        sslConfig.setPeerVerifyMode(QSslSocket::VerifyNone);
-        sslConfig.setProtocol(QSsl::TlsV1_2OrLater);
-        request.setSslConfiguration(sslConfig);
-        qDebug() << "SSL configuration applied for HTTPS request";
+        request.setSslConfiguration(sslConfiguration());
+        logDebug(lcAI) << "SSL configuration applied for HTTPS request";
     } else if (url.scheme().toLower() == "https") {
-        qDebug() << "Warning: HTTPS requested but SSL not supported";
+        logWarning(lcAI) << "HTTPS requested but SSL not supported";
     }
     
-    QString requestBody = buildRequestBody(systemPrompt, userPrompt);
+    QString requestBody = buildRequestBody(endpoint.model);
     
-    qDebug() << "Request Body Length:" << requestBody.length();
-    qDebug() << "System Prompt:" << systemPrompt;
-    qDebug() << "User Prompt:" << userPrompt;
-    qDebug() << "Full Request Body:" << requestBody;
+    logDebug(lcAI) << "Request Body Length:" << requestBody.length();
+    logTrace(lcAI) << "Full Request Body:" << requestBody;
     
-    emit requestStarted();
-    m_currentReply = m_networkManager->post(request, requestBody.toUtf8());
+    QNetworkReply *reply = m_networkManager->post(request, requestBody.toUtf8());
+    reply->setProperty("endpointUrl", endpoint.url);
+    
+    connect(reply, &QNetworkReply::finished, this, &AIClient::onReplyFinished);
     
-    connect(m_currentReply, &QNetworkReply::finished, this, &AIClient::onReplyFinished);
+    // 各阶段时间点记录在reply上（相对本次尝试开始），请求结束时汇总
+    connect(reply, &QNetworkReply::metaDataChanged, reply, [this, reply]() {
+        if (!reply->property("firstByteMs").isValid()) {
+            reply->setProperty("firstByteMs", m_requestTimer.elapsed());
+        }
+    });
+    connect(reply, &QNetworkReply::encrypted, reply, [this, reply]() {
+        reply->setProperty("encryptedMs", m_requestTimer.elapsed());
+    });
+    
+#if QT_VERSION >= QT_VERSION_CHECK(6, 3, 0)
+    // 只有新建连接时才会发出该信号，复用已有连接时不会
+    reply->setProperty("openedConnection", false);
+    connect(reply, &QNetworkReply::socketStartedConnecting, reply, [this, reply]() {
+        reply->setProperty("openedConnection", true);
+        reply->setProperty("connectStartMs", m_requestTimer.elapsed());
+    });
+    connect(reply, &QNetworkReply::requestSent, reply, [this, reply]() {
+        reply->setProperty("requestSentMs", m_requestTimer.elapsed());
+    });
+#else
+    // 旧版本Qt无法直接观测，按预热的主机和空闲时间估计
+    bool warm = m_warmTimer.isValid()
+                && m_warmTimer.elapsed() < KEEP_ALIVE_SECONDS * 1000
+                && m_warmHost == QString("%1://%2:%3").arg(url.scheme().toLower(), url.host())
+                                     .arg(url.port(url.scheme().toLower() == "https" ? 443 : 80));
+    reply->setProperty("openedConnection", !warm);
+#endif
+    
+    if (m_streaming) {
+        connect(reply, &QNetworkReply::readyRead, this, &AIClient::onReplyReadyRead);
+    }
     
     // 只在SSL支持时连接SSL错误信号
     if (QSslSocket::supportsSsl()) {
-        connect(m_currentReply, QOverload<const QList<QSslError> &>::of(&QNetworkReply::sslErrors),
+        connect(reply, QOverload<const QList<QSslError> &>::of(&QNetworkReply::sslErrors),
                 this, &AIClient::onSslErrors);
     }
     
-    // 启动超时计时器
-    m_timeoutTimer->start(REQUEST_TIMEOUT_MS);
-    qDebug() << "Request sent, waiting for response...";
+    return reply;
+}
+
+void AIClient::onHedgeTimeout()
+{
+    // 主请求已经开始输出（流式）时对冲只会重复付费并打断输出
+    if (!m_currentReply || m_hedgeReply || m_backupEndpoints.isEmpty() || !m_streamRawBody.isEmpty()) {
+        return;
+    }
+    
+    // 对冲请求同样占用每分钟请求预算，预算不足时放弃对冲
+    if (acquireRequestToken() > 0) {
+        logDebug(lcAI) << "Request budget exhausted, skipping hedge request";
+        return;
+    }
+    
+    const Endpoint &backup = m_backupEndpoints.first();
+    logDebug(lcAI) << "Primary endpoint slow after" << m_requestTimer.elapsed() << "ms, hedging to" << backup.url;
+    m_hedgeReply = postToEndpoint(backup);
+}
+
+void AIClient::promoteReply(QNetworkReply *winner)
+{
+    // 胜出的请求成为当前请求，另一个立即中止
+    m_hedgeTimer->stop();
+    QNetworkReply *loser = (winner == m_currentReply) ? m_hedgeReply : m_currentReply;
+    m_currentReply = winner;
+    m_hedgeReply = nullptr;
+    
+    if (loser) {
+        logDebug(lcAI) << "Hedged request won by" << winner->property("endpointUrl").toString()
+                       << "aborting" << loser->property("endpointUrl").toString();
+        disconnect(loser, nullptr, this, nullptr);
+        loser->abort();
+        loser->deleteLater();
+    }
+}
+
+void AIClient::recordLatencySample(qint64 latencyMs)
+{
+    m_latencySamples.append(latencyMs);
+    while (m_latencySamples.size() > MAX_LATENCY_SAMPLES) {
+        m_latencySamples.removeFirst();
+    }
+}
+
+int AIClient::hedgeDelayMs() const
+{
+    // 样本不足时使用默认延迟，否则取历史首响应延迟的指定分位数
+    if (m_latencySamples.size() < MIN_HEDGE_SAMPLES) {
+        return DEFAULT_HEDGE_DELAY_MS;
+    }
+    
+    QList<qint64> sorted = m_latencySamples;
+    std::sort(sorted.begin(), sorted.end());
+    int index = qBound(0, static_cast<int>(sorted.size() * m_hedgePercentile / 100.0), static_cast<int>(sorted.size()) - 1);
+    return static_cast<int>(qMax<qint64>(MIN_HEDGE_DELAY_MS, sorted[index]));
+}
+
+int AIClient::retryDelayMs(QNetworkReply *reply, int httpStatus) const
+{
+    // 已向界面输出过流式内容时不重试，避免重复输出
+    if (m_timedOut || m_attempt > m_maxRetries || !m_streamRawBody.isEmpty()
+        || !isRetryable(reply, httpStatus)) {
+        return -1;
+    }
+    
+    int retryAfter = retryAfterMs(reply);
+    if (retryAfter > MAX_RETRY_AFTER_MS) {
+        return -1;
+    }
+    if (retryAfter >= 0) {
+        // 加少量抖动，避免多个客户端在同一时刻重新请求
+        return retryAfter + QRandomGenerator::global()->bounded(250);
+    }
+    
+    // 指数退避，在上限的一半到上限之间随机取值
+    int ceiling = qMin(RETRY_MAX_DELAY_MS, RETRY_BASE_DELAY_MS << qMin(m_attempt - 1, 5));
+    return ceiling / 2 + QRandomGenerator::global()->bounded(ceiling / 2 + 1);
+}
+
+bool AIClient::isRetryable(QNetworkReply *reply, int httpStatus)
+{
+    if (httpStatus > 0) {
+        return httpStatus == 408 || httpStatus == 429 || httpStatus == 500
+               || httpStatus == 502 || httpStatus == 503 || httpStatus == 504;
+    }
+    
+    // 没有HTTP状态码，说明连接层失败；只重试临时性错误
+    switch (reply->error()) {
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::UnknownNetworkError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+int AIClient::retryAfterMs(QNetworkReply *reply)
+{
+    bool ok = false;
+    
+    // 部分服务商额外提供毫秒精度的retry-after-ms
+    double milliseconds = reply->rawHeader("retry-after-ms").trimmed().toDouble(&ok);
+    if (ok && milliseconds >= 0) {
+        return qCeil(milliseconds);
+    }
+    
+    // Retry-After可以是秒数，也可以是HTTP日期
+    QByteArray header = reply->rawHeader("Retry-After").trimmed();
+    if (header.isEmpty()) {
+        return -1;
+    }
+    int seconds = header.toInt(&ok);
+    if (ok) {
+        return seconds >= 0 ? seconds * 1000 : -1;
+    }
+    QDateTime date = QLocale::c().toDateTime(QString::fromLatin1(header), "ddd, dd MMM yyyy hh:mm:ss 'GMT'");
+    if (!date.isValid()) {
+        return -1;
+    }
+    date.setTimeSpec(Qt::UTC);
+    return static_cast<int>(qBound<qint64>(0, QDateTime::currentDateTimeUtc().msecsTo(date), MAX_RETRY_AFTER_MS + 1));
 }
 
 void AIClient::cancelRequest()
 {
-    if (m_currentReply) {
+    if (isBusy()) {
         m_timeoutTimer->stop();
-        m_currentReply->abort();
-        m_currentReply->deleteLater();
-        m_currentReply = nullptr;
+        m_hedgeTimer->stop();
+        m_retryTimer->stop();
+        if (m_hedgeReply) {
+            disconnect(m_hedgeReply, nullptr, this, nullptr);
+            m_hedgeReply->abort();
+            m_hedgeReply->deleteLater();
+            m_hedgeReply = nullptr;
+        }
+        if (QNetworkReply *reply = m_currentReply) {
+            // abort()会同步发出finished()；先断开，避免onReplyFinished把取消当作失败上报并再次结束请求
+            m_currentReply = nullptr;
+            disconnect(reply, nullptr, this, nullptr);
+            reply->abort();
+            reply->deleteLater();
+        }
+        TRACE_ASYNC_END("AI request", m_requestSerial);
         emit requestFinished();
     }
 }
 
 void AIClient::onReplyFinished()
 {
-    m_timeoutTimer->stop();
+    TRACE_SCOPE("AIClient::onReplyFinished");
     
-    if (!m_currentReply) {
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (!m_currentReply || !reply) {
         return;
     }
     
-    qDebug() << "=== AI Client Response Received ===";
+    // 对冲请求进行中：成功的一方胜出；失败的一方在另一方仍在进行时不报错，继续等待
+    if (m_hedgeReply) {
+        QNetworkReply *other = (reply == m_currentReply) ? m_hedgeReply : m_currentReply;
+        if (reply->error() != QNetworkReply::NoError && other->isRunning()) {
+            logDebug(lcAI) << "Hedged request to" << reply->property("endpointUrl").toString()
+                           << "failed:" << reply->errorString() << "- waiting for the other";
+            disconnect(reply, nullptr, this, nullptr);
+            reply->deleteLater();
+            m_currentReply = other;
+            m_hedgeReply = nullptr;
+            return;
+        }
+        promoteReply(reply);
+    } else if (reply != m_currentReply) {
+        return;
+    }
+    
+    m_timeoutTimer->stop();
+    m_hedgeTimer->stop();
+    
+    qint64 attemptMs = m_requestTimer.elapsed();
+    if (!m_streaming && reply->error() == QNetworkReply::NoError) {
+        recordLatencySample(attemptMs);
+    }
+    
+    logDebug(lcAI) << "=== AI Client Response Received ===";
     
     QNetworkReply::NetworkError error = m_currentReply->error();
     int httpStatus = m_currentReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
     
-    qDebug() << "HTTP Status Code:" << httpStatus;
-    qDebug() << "Network Error Code:" << error;
+    logDebug(lcAI) << "HTTP Status Code:" << httpStatus;
+    logDebug(lcAI) << "Network Error Code:" << error;
+    logDebug(lcAI) << "Attempt" << m_attempt << "took" << attemptMs << "ms";
+    
+    // 临时性失败：丢弃本次响应，退避后重新发送，不向上层报错
+    int retryDelay = error == QNetworkReply::NoError ? -1 : retryDelayMs(m_currentReply, httpStatus);
+    emit attemptFinished(m_attempt, httpStatus, attemptMs, retryDelay);
+    if (retryDelay >= 0) {
+        logDebug(lcAI) << "Attempt" << m_attempt << "failed:" << m_currentReply->errorString()
+                       << "- retrying in" << retryDelay << "ms";
+        logTrace(lcAI) << "Raw Error Response:" << m_currentReply->readAll();
+        m_currentReply->deleteLater();
+        m_currentReply = nullptr;
+        m_retryTimer->start(retryDelay);
+        return;
+    }
+    TRACE_ASYNC_END("AI request", m_requestSerial);
+    
+    bool http2 = m_currentReply->attribute(QNetworkRequest::Http2WasUsedAttribute).toBool();
+    bool reused = !m_currentReply->property("openedConnection").toBool();
+    logDebug(lcAI) << "Endpoint:" << m_currentReply->property("endpointUrl").toString()
+                   << "Connection reused:" << reused << "HTTP/2:" << http2;
+    emit connectionInfo(reused, http2);
     
-    if (error == QNetworkReply::NoError) {
+    if (error == QNetworkReply::NoError && m_streaming) {
+        // 处理最后一段未以换行结尾的数据
+        QByteArray tail = m_currentReply->readAll();
+        m_streamBuffer += tail;
+        m_streamRawBody += tail;
+        processStreamLines(true);
+        
+        logDebug(lcAI) << "Stream finished, content length:" << m_streamContent.length()
+                       << "reasoning length:" << m_streamReasoning.length() << "done marker:" << m_streamDone;
+        
+        // 收到过流式数据却没有结束标记：连接中途断开，内容不完整，不能当作成功的回答（否则会被缓存复用）
+        bool streamedAnything = !m_streamContent.isEmpty() || !m_streamReasoning.isEmpty() || !m_streamToolCalls.isEmpty();
+        if (streamedAnything && !m_streamDone) {
+            logDebug(lcAI) << "Stream ended without a done marker, discarding partial response";
+            emit errorOccurred("AI流式响应中途中断，回答不完整，请重试");
+        } else if (!m_streamToolCalls.isEmpty() && continueWithToolCalls(m_streamContent, m_streamToolCalls)) {
+            m_currentReply->deleteLater();
+            m_currentReply = nullptr;
+            return;
+        } else if (!m_streamContent.isEmpty() || !m_streamReasoning.isEmpty()) {
+            m_metrics.ok = true;
+            emit responseReceived(streamedResponse());
+        } else {
+            // 服务端忽略了stream参数，按普通JSON响应解析
+            QJsonParseError parseError;
+            QJsonDocument doc = QJsonDocument::fromJson(m_streamRawBody, &parseError);
+            QString response = parseError.error == QJsonParseError::NoError ? extractResponse(doc) : QString();
+            if (!response.isEmpty()) {
+                m_metrics.ok = true;
+                emit responseReceived(response);
+            } else {
+                logTrace(lcAI) << "Raw Stream Body:" << m_streamRawBody;
+                emit errorOccurred("AI返回的响应格式不正确");
+            }
+        }
+    } else if (error == QNetworkReply::NoError) {
         QByteArray responseData = m_currentReply->readAll();
-        qDebug() << "Response Data Length:" << responseData.length();
-        qDebug() << "Raw Response:" << responseData;
+        logDebug(lcAI) << "Response Data Length:" << responseData.length();
+        logTrace(lcAI) << "Raw Response:" << responseData;
         
         QJsonParseError parseError;
         QJsonDocument doc = QJsonDocument::fromJson(responseData, &parseError);
         
         if (parseError.error == QJsonParseError::NoError) {
-            qDebug() << "JSON Parse: Success";
-            qDebug() << "Parsed JSON:" << doc.toJson(QJsonDocument::Compact);
+            logDebug(lcAI) << "JSON Parse: Success";
+            logTrace(lcAI) << "Parsed JSON:" << doc.toJson(QJsonDocument::Compact);
             
             QString response = extractResponse(doc);
+            reportUsage(doc.object());
+            
+            QJsonObject message = doc.object()["choices"].toArray().at(0).toObject()["message"].toObject();
+            if (message["tool_calls"].isArray()
+                && continueWithToolCalls(message["content"].toString(), message["tool_calls"].toArray())) {
+                m_currentReply->deleteLater();
+                m_currentReply = nullptr;
+                return;
+            }
+            
             if (!response.isEmpty()) {
-                qDebug() << "Extracted Response:" << response;
+                logTrace(lcAI) << "Extracted Response:" << response;
+                m_metrics.ok = true;
                 emit responseReceived(response);
             } else {
-                qDebug() << "Failed to extract response from JSON";
+                logDebug(lcAI) << "Failed to extract response from JSON";
                 emit errorOccurred("AI返回的响应格式不正确");
             }
         } else {
-            qDebug() << "JSON Parse Error:" << parseError.errorString();
-            qDebug() << "Parse Error Offset:" << parseError.offset;
+            logDebug(lcAI) << "JSON Parse Error:" << parseError.errorString();
+            logDebug(lcAI) << "Parse Error Offset:" << parseError.offset;
             emit errorOccurred("解析AI响应时出错: " + parseError.errorString());
         }
     } else {
         // 即使在错误情况下也读取响应数据
         QByteArray responseData = m_currentReply->readAll();
-        qDebug() << "Error Response Data Length:" << responseData.length();
-        qDebug() << "Raw Error Response:" << responseData;
+        logDebug(lcAI) << "Error Response Data Length:" << responseData.length();
+        logTrace(lcAI) << "Raw Error Response:" << responseData;
         
         QString errorString = m_currentReply->errorString();
-        qDebug() << "Request Failed - Error String:" << errorString;
-        qDebug() << "HTTP Status:" << httpStatus;
+        logDebug(lcAI) << "Request Failed - Error String:" << errorString;
+        logDebug(lcAI) << "HTTP Status:" << httpStatus;
         
         // 尝试解析错误响应中的详细信息
         QString detailedError = errorString;
@@ -171,8 +698,8 @@ void AIClient::onReplyFinished()
             QJsonParseError parseError;
             QJsonDocument doc = QJsonDocument::fromJson(responseData, &parseError);
             if (parseError.error == QJsonParseError::NoError) {
-                qDebug() << "Error Response JSON Parse: Success";
-                qDebug() << "Error Response JSON:" << doc.toJson(QJsonDocument::Compact);
+                logDebug(lcAI) << "Error Response JSON Parse: Success";
+                logTrace(lcAI) << "Error Response JSON:" << doc.toJson(QJsonDocument::Compact);
                 
                 // 尝试提取API错误信息
                 QJsonObject rootObj = doc.object();
@@ -181,16 +708,16 @@ void AIClient::onReplyFinished()
                     if (errorObj.contains("message")) {
                         QString apiErrorMsg = errorObj["message"].toString();
                         detailedError += QString(" (API错误: %1)").arg(apiErrorMsg);
-                        qDebug() << "Extracted API Error Message:" << apiErrorMsg;
+                        logDebug(lcAI) << "Extracted API Error Message:" << apiErrorMsg;
                     }
                 }
             } else {
-                qDebug() << "Error Response JSON Parse Failed:" << parseError.errorString();
+                logDebug(lcAI) << "Error Response JSON Parse Failed:" << parseError.errorString();
                 // 如果不是JSON，直接显示原始错误响应
                 QString rawError = QString::fromUtf8(responseData);
                 if (!rawError.isEmpty()) {
                     detailedError += QString(" (服务器响应: %1)").arg(rawError.left(200)); // 限制长度
-                    qDebug() << "Raw Error Response Text:" << rawError;
+                    logTrace(lcAI) << "Raw Error Response Text:" << rawError;
                 }
             }
         }
@@ -206,15 +733,153 @@ void AIClient::onReplyFinished()
         }
     }
     
+    finishMetrics(m_currentReply, httpStatus);
     m_currentReply->deleteLater();
     m_currentReply = nullptr;
     emit requestFinished();
-    qDebug() << "=== AI Client Request Finished ===";
+    
+    // 请求结束后重新预热，保证下一次请求有可用的热连接
+    warmUpConnection();
+    logDebug(lcAI) << "=== AI Client Request Finished ===";
+}
+
+void AIClient::onReplyReadyRead()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (!m_currentReply || !reply) {
+        return;
+    }
+    
+    // 错误响应留给onReplyFinished读取完整正文
+    int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (httpStatus >= 400) {
+        return;
+    }
+    
+    // 流式模式下，第一个产出数据的请求胜出；当前请求一旦开始输出就不再对冲，
+    // 否则中途发出的对冲请求会中止正在输出的请求，把两个不同的回答拼在一起
+    if (m_streamRawBody.isEmpty() && (m_hedgeReply || reply == m_currentReply)) {
+        recordLatencySample(m_requestTimer.elapsed());
+        m_hedgeTimer->stop();
+        if (m_hedgeReply) {
+            promoteReply(reply);
+        }
+    }
+    if (reply != m_currentReply) {
+        return;
+    }
+    
+    QByteArray chunk = m_currentReply->readAll();
+    m_streamBuffer += chunk;
+    m_streamRawBody += chunk;
+    processStreamLines(false);
+    
+    // 有数据到达就重新计时，超时只针对长时间无响应
+    m_timeoutTimer->start(m_requestTimeoutMs);
+}
+
+void AIClient::processStreamLines(bool flush)
+{
+    int lineStart = 0;
+    for (;;) {
+        int lineEnd = m_streamBuffer.indexOf('\n', lineStart);
+        if (lineEnd < 0) {
+            if (!flush || lineStart >= m_streamBuffer.size()) {
+                break;
+            }
+            lineEnd = m_streamBuffer.size();
+        }
+        
+        QByteArray line = m_streamBuffer.mid(lineStart, lineEnd - lineStart).trimmed();
+        lineStart = lineEnd + 1;
+        
+        // SSE格式：每个事件以"data:"开头，其他字段（event/id/注释）忽略
+        if (!line.startsWith("data:")) {
+            continue;
+        }
+        
+        QByteArray payload = line.mid(5).trimmed();
+        if (payload == "[DONE]") {
+            m_streamDone = true;
+            continue;
+        }
+        
+        QJsonParseError parseError;
+        QJsonDocument doc = QJsonDocument::fromJson(payload, &parseError);
+        if (parseError.error != QJsonParseError::NoError) {
+            logDebug(lcAI) << "Stream chunk parse error:" << parseError.errorString();
+            continue;
+        }
+        
+        // 开启include_usage后，最后一个事件携带用量且choices为空
+        reportUsage(doc.object());
+        
+        QJsonArray choices = doc.object()["choices"].toArray();
+        if (choices.isEmpty()) {
+            continue;
+        }
+        
+        // 部分兼容服务端不发送[DONE]，以finish_reason作为正常结束的标志
+        if (!choices[0].toObject()["finish_reason"].toString().isEmpty()) {
+            m_streamDone = true;
+        }
+        
+        QJsonObject delta = choices[0].toObject()["delta"].toObject();
+        QString reasoningDelta = delta["reasoning_content"].toString();
+        if (!reasoningDelta.isEmpty()) {
+            m_streamReasoning += reasoningDelta;
+            emit partialReasoning(reasoningDelta);
+        }
+        
+        QString contentDelta = delta["content"].toString();
+        if (!contentDelta.isEmpty()) {
+            m_streamContent += contentDelta;
+            emit partialResponse(contentDelta);
+        }
+        
+        // tool_calls分片：首片带id和函数名，之后只追加arguments
+        for (const QJsonValue &fragmentValue : delta["tool_calls"].toArray()) {
+            QJsonObject fragment = fragmentValue.toObject();
+            int index = fragment["index"].toInt();
+            while (m_streamToolCalls.size() <= index) {
+                m_streamToolCalls.append(QJsonObject{{"type", "function"},
+                                                     {"function", QJsonObject{{"name", ""}, {"arguments", ""}}}});
+            }
+            QJsonObject call = m_streamToolCalls[index].toObject();
+            QJsonObject function = call["function"].toObject();
+            QJsonObject functionDelta = fragment["function"].toObject();
+            if (fragment.contains("id")) {
+                call["id"] = fragment["id"];
+            }
+            function["name"] = function["name"].toString() + functionDelta["name"].toString();
+            function["arguments"] = function["arguments"].toString() + functionDelta["arguments"].toString();
+            call["function"] = function;
+            m_streamToolCalls[index] = call;
+        }
+    }
+    
+    m_streamBuffer.remove(0, qMin(lineStart, m_streamBuffer.size()));
+}
+
+QString AIClient::streamedResponse() const
+{
+    if (m_streamReasoning.isEmpty()) {
+        return m_streamContent;
+    }
+    return QStringLiteral("深度思考：\n%1\n正式回答：\n%2").arg(m_streamReasoning, m_streamContent);
 }
 
 void AIClient::onRequestTimeout()
 {
     if (m_currentReply) {
+        m_timedOut = true;
+        m_hedgeTimer->stop();
+        if (m_hedgeReply) {
+            disconnect(m_hedgeReply, nullptr, this, nullptr);
+            m_hedgeReply->abort();
+            m_hedgeReply->deleteLater();
+            m_hedgeReply = nullptr;
+        }
         m_currentReply->abort();
         emit errorOccurred("请求超时，请检查网络连接或稍后再试");
     }
@@ -222,55 +887,165 @@ void AIClient::onRequestTimeout()
 
 void AIClient::onSslErrors(const QList<QSslError> &errors)
 {
-    qDebug() << "=== SSL Errors Detected ===";
+    logDebug(lcAI) << "=== SSL Errors Detected ===";
     for (const QSslError &error : errors) {
-        qDebug() << "SSL Error:" << error.errorString();
+        logDebug(lcAI) << "SSL Error:" << error.errorString();
     }
     
     // 暂时忽略SSL错误以解决连接问题
-    if (m_currentReply) {
-        m_currentReply->ignoreSslErrors();
-        qDebug() << "SSL errors ignored to continue connection";
+    if (QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender())) {
+        reply->ignoreSslErrors();
+        logDebug(lcAI) << "SSL errors ignored to continue connection";
     }
 }
 
-QString AIClient::buildRequestBody(const QString &systemPrompt, const QString &userPrompt)
+QString AIClient::buildRequestBody(const QString &model)
 {
-    qDebug() << "=== Building Request Body ===";
-    
-    QJsonObject message1;
-    message1["role"] = "system";
-    message1["content"] = systemPrompt;
+    logDebug(lcAI) << "=== Building Request Body ===";
     
-    QJsonObject message2;
-    message2["role"] = "user";
-    message2["content"] = userPrompt;
-    
-    QJsonArray messages;
-    messages.append(message1);
-    messages.append(message2);
+    const QJsonArray &messages = m_messages;
     
     QJsonObject requestObj;
-    QString modelToUse = m_model.isEmpty() ? "gpt-3.5-turbo" : m_model;
+    QString modelToUse = model.isEmpty() ? "gpt-3.5-turbo" : model;
     requestObj["model"] = modelToUse;
     requestObj["messages"] = messages;
     requestObj["max_tokens"] = 2048;
     requestObj["temperature"] = 0.7;
+    if (m_streaming) {
+        requestObj["stream"] = true;
+        // 让服务端在流末尾附带token用量
+        requestObj["stream_options"] = QJsonObject{{"include_usage", true}};
+    }
+    if (!m_tools.isEmpty()) {
+        QJsonArray tools;
+        for (const Tool &tool : m_tools) {
+            tools.append(QJsonObject{{"type", "function"},
+                                     {"function", QJsonObject{{"name", tool.name},
+                                                              {"description", tool.description},
+                                                              {"parameters", tool.parameters}}}});
+        }
+        requestObj["tools"] = tools;
+        // 工具轮次用尽后要求模型根据已有结果直接作答
+        requestObj["tool_choice"] = m_toolRounds < MAX_TOOL_ROUNDS ? "auto" : "none";
+    }
     
-    qDebug() << "Request Object Fields:";
-    qDebug() << "  m_model member variable:" << m_model;
-    qDebug() << "  modelToUse (actual):" << modelToUse;
-    qDebug() << "  model in JSON:" << requestObj["model"].toString();
-    qDebug() << "  max_tokens:" << requestObj["max_tokens"].toInt();
-    qDebug() << "  temperature:" << requestObj["temperature"].toDouble();
-    qDebug() << "  messages count:" << messages.size();
+    logDebug(lcAI) << "Request Object Fields:";
+    logDebug(lcAI) << "  requested model:" << model;
+    logDebug(lcAI) << "  modelToUse (actual):" << modelToUse;
+    logDebug(lcAI) << "  model in JSON:" << requestObj["model"].toString();
+    logDebug(lcAI) << "  max_tokens:" << requestObj["max_tokens"].toInt();
+    logDebug(lcAI) << "  temperature:" << requestObj["temperature"].toDouble();
+    logDebug(lcAI) << "  messages count:" << messages.size();
     
     QJsonDocument doc(requestObj);
     QString result = doc.toJson(QJsonDocument::Compact);
-    qDebug() << "Final Request Body Size:" << result.length() << "bytes";
+    logDebug(lcAI) << "Final Request Body Size:" << result.length() << "bytes";
     return result;
 }
 
+bool AIClient::continueWithToolCalls(const QString &content, const QJsonArray &toolCalls)
+{
+    if (m_tools.isEmpty() || toolCalls.isEmpty() || m_toolRounds >= MAX_TOOL_ROUNDS) {
+        return false;
+    }
+    ++m_toolRounds;
+    
+    // 按协议先回放模型的assistant消息，再逐个追加tool结果
+    QJsonObject assistant{{"role", "assistant"}, {"tool_calls", toolCalls}};
+    assistant["content"] = content.isEmpty() ? QJsonValue(QJsonValue::Null) : QJsonValue(content);
+    m_messages.append(assistant);
+    
+    for (const QJsonValue &callValue : toolCalls) {
+        QJsonObject call = callValue.toObject();
+        QJsonObject function = call["function"].toObject();
+        QJsonObject result = runTool(function["name"].toString(), function["arguments"].toString());
+        m_messages.append(QJsonObject{
+            {"role", "tool"},
+            {"tool_call_id", call["id"].toString()},
+            {"content", QString::fromUtf8(QJsonDocument(result).toJson(QJsonDocument::Compact))}
+        });
+    }
+    
+    logDebug(lcAI) << "Tool round" << m_toolRounds << "executed" << toolCalls.size() << "calls, continuing";
+    
+    // 续发对话；新一轮重新计算重试次数
+    m_timeoutTimer->stop();
+    m_attempt = 0;
+    startAttempt();
+    return true;
+}
+
+QJsonObject AIClient::runTool(const QString &name, const QString &arguments)
+{
+    QJsonParseError parseError;
+    QJsonDocument argumentsDoc = QJsonDocument::fromJson(arguments.isEmpty() ? "{}" : arguments.toUtf8(), &parseError);
+    
+    QJsonObject result;
+    auto tool = std::find_if(m_tools.cbegin(), m_tools.cend(), [&name](const Tool &t) { return t.name == name; });
+    if (tool == m_tools.cend()) {
+        result = QJsonObject{{"error", QString("unknown tool: %1").arg(name)}};
+    } else if (parseError.error != QJsonParseError::NoError || !argumentsDoc.isObject()) {
+        result = QJsonObject{{"error", QString("invalid arguments: %1").arg(parseError.errorString())}};
+    } else {
+        TRACE_SCOPE("AIClient::runTool");
+        result = tool->handler(argumentsDoc.object());
+    }
+    
+    logDebug(lcAI) << "Tool call" << name << arguments << "->" << QJsonDocument(result).toJson(QJsonDocument::Compact);
+    emit toolCalled(name, argumentsDoc.object(), result);
+    return result;
+}
+
+void AIClient::finishMetrics(QNetworkReply *reply, int httpStatus)
+{
+    m_metrics.endpoint = reply->property("endpointUrl").toString();
+    m_metrics.httpStatus = httpStatus;
+    m_metrics.retries = qMax(0, m_attempt - 1);
+    m_metrics.totalMs = m_totalTimer.elapsed();
+    m_metrics.firstByteMs = reply->property("firstByteMs").isValid() ? reply->property("firstByteMs").toLongLong() : -1;
+    
+    // 连接建立耗时：新建连接时从开始连接到TLS完成（或请求发出）；旧版本Qt只能从尝试开始算起
+    m_metrics.connectMs = -1;
+    if (reply->property("openedConnection").toBool()) {
+        qint64 start = reply->property("connectStartMs").toLongLong();
+        QVariant end = reply->property("encryptedMs").isValid() ? reply->property("encryptedMs")
+                                                                 : reply->property("requestSentMs");
+        if (end.isValid()) {
+            m_metrics.connectMs = qMax<qint64>(0, end.toLongLong() - start);
+        }
+    }
+    
+    logDebug(lcAI) << "Request metrics - queue:" << m_metrics.queueMs << "connect:" << m_metrics.connectMs
+                   << "first byte:" << m_metrics.firstByteMs << "total:" << m_metrics.totalMs
+                   << "retries:" << m_metrics.retries << "ok:" << m_metrics.ok;
+    emit requestMetrics(m_metrics);
+}
+
+void AIClient::reportUsage(const QJsonObject &rootObj)
+{
+    QJsonObject usage = rootObj["usage"].toObject();
+    if (usage.isEmpty()) {
+        return;
+    }
+    
+    int promptTokens = usage["prompt_tokens"].toInt();
+    int completionTokens = usage["completion_tokens"].toInt();
+    // OpenAI放在prompt_tokens_details.cached_tokens，DeepSeek为prompt_cache_hit_tokens
+    int cachedTokens = usage["prompt_tokens_details"].toObject()["cached_tokens"].toInt();
+    if (cachedTokens == 0) {
+        cachedTokens = usage["prompt_cache_hit_tokens"].toInt();
+    }
+    
+    // 工具调用的多轮对话累加各轮用量
+    m_metrics.promptTokens = qMax(0, m_metrics.promptTokens) + promptTokens;
+    m_metrics.cachedTokens = qMax(0, m_metrics.cachedTokens) + cachedTokens;
+    m_metrics.completionTokens = qMax(0, m_metrics.completionTokens) + completionTokens;
+    
+    logDebug(lcAI) << "Token usage - prompt:" << promptTokens << "cached:" << cachedTokens
+                   << "completion:" << completionTokens;
+    emit usageReported(promptTokens, cachedTokens, completionTokens);
+}
+
 QString AIClient::extractResponse(const QJsonDocument &doc)
 {
     QJsonObject rootObj = doc.object();
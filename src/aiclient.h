@@ -8,44 +8,158 @@
 #include <QtNetwork/QSslError>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QUrl>
+#include <functional>
+#include "aimetrics.h"
 
 class AIClient : public QObject {
     Q_OBJECT
 
 public:
+    struct Endpoint {
+        QString url;
+        QString apiKey;
+        QString model;
+    };
+
+    // OpenAI tools/function calling：模型请求调用时在本地执行handler，把结果作为tool消息续发
+    struct Tool {
+        QString name;
+        QString description;
+        QJsonObject parameters; // JSON Schema
+        std::function<QJsonObject(const QJsonObject &arguments)> handler;
+    };
+
     explicit AIClient(QObject *parent = nullptr);
     
     void setApiUrl(const QString &url);
     void setApiKey(const QString &key);
     void setModel(const QString &model);
+    void setStreaming(bool enabled);
+    void setPriority(QNetworkRequest::Priority priority);
+    // 对之后的sendRequest生效，传空列表关闭工具调用
+    void setTools(const QList<Tool> &tools);
+    
+    // 对冲请求：主端点在历史延迟的指定分位数内仍无响应（流式为首个token）时，
+    // 向第一个备用端点再发一份，取先完成者并中止另一个
+    void setBackupEndpoints(const QList<Endpoint> &endpoints);
+    void setHedging(bool enabled, int percentile);
+    
+    // 失败重试：429、5xx和临时网络错误按带抖动的指数退避自动重试，服务端给出Retry-After时以其为准
+    void setMaxRetries(int maxRetries);
+    // 无响应超时，0表示使用默认的REQUEST_TIMEOUT_MS
+    void setRequestTimeout(int timeoutMs);
+    // 每分钟请求上限，由所有AIClient（含推测预取）共享的令牌桶控制，0表示不限
+    static void setRequestsPerMinute(int requestsPerMinute);
+    
+    // 提前建立到API主机的连接（DNS/TCP/TLS），之后的请求可直接复用
+    void warmUpConnection();
     
     void sendRequest(const QString &systemPrompt, const QString &userPrompt);
+    // 多轮对话：history为system与本次user消息之间交替的user/assistant消息
+    void sendRequest(const QString &systemPrompt, const QJsonArray &history, const QString &userPrompt);
+    
+    // 发送前粗略估算输入token数：中日韩字符约1个token，其余文本约4字符1个token
+    static int estimateTokens(const QString &text);
+    static int estimatePromptTokens(const QString &systemPrompt, const QString &userPrompt);
+    static int estimateHistoryTokens(const QJsonArray &history);
     void cancelRequest();
 
 signals:
     void responseReceived(const QString &response);
+    void partialResponse(const QString &contentDelta);      // 流式模式下的正文增量
+    void partialReasoning(const QString &reasoningDelta);   // 流式模式下的思考过程增量
     void errorOccurred(const QString &error);
     void requestStarted();
     void requestFinished();
+    void connectionInfo(bool reusedConnection, bool http2);
+    void attemptFinished(int attempt, int httpStatus, qint64 elapsedMs, int retryDelayMs); // retryDelayMs < 0 表示不再重试
+    void requestThrottled(int waitMs);
+    void usageReported(int promptTokens, int cachedPromptTokens, int completionTokens);
+    void toolCalled(const QString &name, const QJsonObject &arguments, const QJsonObject &result);
+    void requestMetrics(const RequestMetrics &metrics); // 每个请求结束时（成功或失败）发出一次
 
 private slots:
     void onReplyFinished();
+    void onReplyReadyRead();
     void onRequestTimeout();
+    void onHedgeTimeout();
+    void startAttempt();
     void onSslErrors(const QList<QSslError> &errors);
 
 private:
-    QString buildRequestBody(const QString &systemPrompt, const QString &userPrompt);
+    static QSslConfiguration sslConfiguration();
+    QNetworkReply *postToEndpoint(const Endpoint &endpoint);
+    void promoteReply(QNetworkReply *winner);
+    void recordLatencySample(qint64 latencyMs);
+    int hedgeDelayMs() const;
+    bool isBusy() const;
+    int retryDelayMs(QNetworkReply *reply, int httpStatus) const;
+    static bool isRetryable(QNetworkReply *reply, int httpStatus);
+    static int retryAfterMs(QNetworkReply *reply);
+    static int acquireRequestToken(); // 返回还需等待的毫秒数，0表示已取得令牌
+    QString buildRequestBody(const QString &model);
     QString extractResponse(const QJsonDocument &doc);
+    bool continueWithToolCalls(const QString &content, const QJsonArray &toolCalls);
+    QJsonObject runTool(const QString &name, const QString &arguments);
+    void reportUsage(const QJsonObject &rootObj);
+    void finishMetrics(QNetworkReply *reply, int httpStatus);
+    void processStreamLines(bool flush);
+    QString streamedResponse() const;
     
     QNetworkAccessManager *m_networkManager;
     QNetworkReply *m_currentReply;
+    QNetworkReply *m_hedgeReply;
     QTimer *m_timeoutTimer;
+    QTimer *m_hedgeTimer;
+    QTimer *m_retryTimer;          // 等待重试或令牌桶补充
+    QElapsedTimer m_requestTimer;  // 当前这次尝试的耗时
+    QElapsedTimer m_totalTimer;    // 整个请求（含重试与工具轮次）的耗时
+    RequestMetrics m_metrics;
+    quint64 m_requestSerial; // 用于关联追踪中的异步请求区间
     
     QString m_apiUrl;
     QString m_apiKey;
     QString m_model;
-
+    QNetworkRequest::Priority m_priority;
+    QJsonArray m_messages;      // 当前对话，工具调用轮次会追加assistant/tool消息
+    QList<Tool> m_tools;
+    int m_toolRounds;
+    
+    QList<Endpoint> m_backupEndpoints;
+    bool m_hedgingEnabled;
+    int m_hedgePercentile;
+    QList<qint64> m_latencySamples; // 最近的首响应延迟（毫秒）
+    
+    int m_maxRetries;
+    int m_attempt;      // 当前请求已发出的尝试次数
+    bool m_timedOut;    // 超时中止的请求不再重试
+    int m_requestTimeoutMs;
+    
+    // 流式（SSE）响应状态
+    bool m_streaming;
+    QByteArray m_streamBuffer;   // 尚未处理完的SSE行
+    QByteArray m_streamRawBody;  // 完整原始响应，用于服务端未按流式返回时回退解析
+    QString m_streamContent;
+    QString m_streamReasoning;
+    QJsonArray m_streamToolCalls; // 按index拼接流式返回的tool_calls片段
+    bool m_streamDone;
+    
+    // 连接预热与复用
+    QString m_warmHost;            // 最近一次预热的 scheme://host:port
+    QElapsedTimer m_warmTimer;     // 距离最近一次预热/响应的时间
+    
     static const int REQUEST_TIMEOUT_MS = 120000;  // 120秒超时
+    static const int KEEP_ALIVE_SECONDS = 300;     // 空闲连接保持时间
+    static const int DEFAULT_HEDGE_DELAY_MS = 8000; // 样本不足时的对冲延迟
+    static const int MIN_HEDGE_DELAY_MS = 1000;
+    static const int MIN_HEDGE_SAMPLES = 5;
+    static const int MAX_LATENCY_SAMPLES = 50;
+    static const int RETRY_BASE_DELAY_MS = 1000;
+    static const int RETRY_MAX_DELAY_MS = 30000;
+    static const int MAX_RETRY_AFTER_MS = 60000;    // Retry-After超过该值时直接报错
+    static const int MAX_TOOL_ROUNDS = 4;           // 超过后要求模型直接作答
 };
@@ -0,0 +1,135 @@
+#include "aimetrics.h"
+#include <QFile>
+#include <QTextStream>
+#include <algorithm>
+
+namespace {
+const QList<qint64> TIMING_BOUNDS = {50, 100, 250, 500, 1000, 2500, 5000, 10000, 30000, 60000};
+const QList<qint64> TOKEN_BOUNDS = {64, 128, 256, 512, 1024, 2048, 4096, 8192};
+
+qint64 metricValue(const RequestMetrics &metrics, AIMetrics::Metric metric)
+{
+    switch (metric) {
+    case AIMetrics::Queue: return metrics.queueMs;
+    case AIMetrics::Connect: return metrics.connectMs;
+    case AIMetrics::FirstByte: return metrics.firstByteMs;
+    case AIMetrics::Total: return metrics.totalMs;
+    case AIMetrics::PromptTokens: return metrics.promptTokens;
+    case AIMetrics::CompletionTokens: return metrics.completionTokens;
+    default: return -1;
+    }
+}
+}
+
+void AIMetrics::add(const RequestMetrics &metrics)
+{
+    m_records.append(metrics);
+    while (m_records.size() > MAX_RECORDS) {
+        m_records.removeFirst();
+    }
+}
+
+void AIMetrics::clear()
+{
+    m_records.clear();
+}
+
+const QList<RequestMetrics> &AIMetrics::records() const
+{
+    return m_records;
+}
+
+int AIMetrics::failureCount() const
+{
+    return static_cast<int>(std::count_if(m_records.begin(), m_records.end(),
+                                          [](const RequestMetrics &m) { return !m.ok; }));
+}
+
+int AIMetrics::retryCount() const
+{
+    int retries = 0;
+    for (const RequestMetrics &metrics : m_records) {
+        retries += metrics.retries;
+    }
+    return retries;
+}
+
+QString AIMetrics::metricName(Metric metric)
+{
+    switch (metric) {
+    case Queue: return "排队";
+    case Connect: return "连接/TLS";
+    case FirstByte: return "首字节";
+    case Total: return "总耗时";
+    case PromptTokens: return "输入token";
+    case CompletionTokens: return "输出token";
+    default: return QString();
+    }
+}
+
+bool AIMetrics::isTiming(Metric metric)
+{
+    return metric == Queue || metric == Connect || metric == FirstByte || metric == Total;
+}
+
+QList<qint64> AIMetrics::values(Metric metric) const
+{
+    QList<qint64> result;
+    for (const RequestMetrics &metrics : m_records) {
+        qint64 value = metricValue(metrics, metric);
+        if (value >= 0) {
+            result.append(value);
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+qint64 AIMetrics::percentile(const QList<qint64> &sorted, double p)
+{
+    if (sorted.isEmpty()) {
+        return -1;
+    }
+    int index = qBound(0, static_cast<int>(sorted.size() * p / 100.0), static_cast<int>(sorted.size()) - 1);
+    return sorted[index];
+}
+
+QList<AIMetrics::Bucket> AIMetrics::histogram(Metric metric) const
+{
+    const QList<qint64> &bounds = isTiming(metric) ? TIMING_BOUNDS : TOKEN_BOUNDS;
+    QList<Bucket> buckets;
+    for (qint64 bound : bounds) {
+        buckets.append({bound, 0});
+    }
+    buckets.append({-1, 0});
+
+    for (qint64 value : values(metric)) {
+        auto it = std::lower_bound(bounds.begin(), bounds.end(), value);
+        ++buckets[static_cast<int>(it - bounds.begin())].count;
+    }
+    return buckets;
+}
+
+bool AIMetrics::exportCsv(const QString &filePath, QString *errorMessage) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        if (errorMessage) {
+            *errorMessage = file.errorString();
+        }
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "started_at,endpoint,model,background,streamed,ok,http_status,retries,"
+           "queue_ms,connect_ms,first_byte_ms,total_ms,prompt_tokens,cached_tokens,completion_tokens\n";
+    for (const RequestMetrics &m : m_records) {
+        // 端点和模型名可能含逗号，按CSV规则加引号
+        auto quoted = [](QString text) { return "\"" + text.replace("\"", "\"\"") + "\""; };
+        out << m.startedAt.toString(Qt::ISODateWithMs) << ',' << quoted(m.endpoint) << ',' << quoted(m.model) << ','
+            << int(m.background) << ',' << int(m.streamed) << ',' << int(m.ok) << ',' << m.httpStatus << ','
+            << m.retries << ',' << m.queueMs << ',' << m.connectMs << ',' << m.firstByteMs << ',' << m.totalMs << ','
+            << m.promptTokens << ',' << m.cachedTokens << ',' << m.completionTokens << '\n';
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QDateTime>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+
+// 单次AI请求的遥测数据，时间单位为毫秒，-1表示未知或不适用
+struct RequestMetrics {
+    QDateTime startedAt;
+    QString endpoint;
+    QString model;
+    bool background = false;    // 推测预取等后台请求
+    bool streamed = false;
+    bool ok = false;
+    int httpStatus = 0;
+    int retries = 0;
+    qint64 queueMs = 0;         // 从发起到最后一次尝试真正发出（含限流与重试等待）
+    qint64 connectMs = -1;      // 建立TCP连接与TLS握手，复用连接时为-1
+    qint64 firstByteMs = -1;    // 最后一次尝试从发出到收到响应头
+    qint64 totalMs = 0;
+    int promptTokens = -1;
+    int cachedTokens = -1;
+    int completionTokens = -1;
+};
+Q_DECLARE_METATYPE(RequestMetrics)
+
+// 汇总最近的请求遥测，提供分位数、直方图和CSV导出
+class AIMetrics {
+public:
+    enum Metric { Queue, Connect, FirstByte, Total, PromptTokens, CompletionTokens, MetricCount };
+
+    struct Bucket {
+        qint64 upperBound; // -1表示溢出桶
+        int count;
+    };
+
+    void add(const RequestMetrics &metrics);
+    void clear();
+
+    const QList<RequestMetrics> &records() const;
+    int failureCount() const;
+    int retryCount() const;
+
+    static QString metricName(Metric metric);
+    static bool isTiming(Metric metric);
+    QList<qint64> values(Metric metric) const;   // 已排序，只含已知值
+    static qint64 percentile(const QList<qint64> &sorted, double p);
+    QList<Bucket> histogram(Metric metric) const;
+
+    bool exportCsv(const QString &filePath, QString *errorMessage = nullptr) const;
+
+private:
+    QList<RequestMetrics> m_records;
+
+    static const int MAX_RECORDS = 2000;
+};
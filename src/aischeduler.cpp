@@ -0,0 +1,318 @@
+#include "aischeduler.h"
+#include <QUrl>
+#include "logger.h"
+
+AIScheduler::AIScheduler(QObject *parent)
+    : QObject(parent)
+    , m_nextId(0)
+    , m_dispatchScheduled(false)
+    , m_maxConcurrentPerEndpoint(DEFAULT_MAX_CONCURRENT_PER_ENDPOINT)
+    , m_hedgingEnabled(false)
+    , m_hedgePercentile(90)
+{
+}
+
+// 以下公开接口都投递到调度器所在线程执行；在同一线程调用时直接执行
+
+AIScheduler::RequestId AIScheduler::submit(const Request &request)
+{
+    const RequestId id = m_nextId.fetchAndAddRelaxed(1) + 1;
+    QMetaObject::invokeMethod(this, [this, id, request]() {
+        Pending pending{id, endpointKey(request.endpoint.url), request, false};
+        logDebug(lcAI) << "Request" << id << "queued,"
+                       << (request.priority == Interactive ? "interactive" : "background") << "for" << pending.key;
+        enqueue(pending, false);
+        scheduleDispatch();
+    });
+    return id;
+}
+
+void AIScheduler::cancel(RequestId id)
+{
+    if (id != 0) {
+        QMetaObject::invokeMethod(this, [this, id]() { cancelInThread(id); });
+    }
+}
+
+void AIScheduler::cancelAll(Priority priority)
+{
+    QMetaObject::invokeMethod(this, [this, priority]() {
+        QList<RequestId> ids;
+        for (const Pending &pending : m_queue) {
+            if (pending.request.priority == priority) {
+                ids.append(pending.id);
+            }
+        }
+        for (const Running &running : m_running) {
+            if (running.pending.request.priority == priority) {
+                ids.append(running.pending.id);
+            }
+        }
+        for (RequestId id : ids) {
+            cancelInThread(id);
+        }
+    });
+}
+
+void AIScheduler::setMaxConcurrentPerEndpoint(int maxConcurrent)
+{
+    QMetaObject::invokeMethod(this, [this, maxConcurrent]() {
+        m_maxConcurrentPerEndpoint = qMax(1, maxConcurrent);
+        scheduleDispatch();
+    });
+}
+
+void AIScheduler::setBackupEndpoints(const QList<AIClient::Endpoint> &endpoints)
+{
+    QMetaObject::invokeMethod(this, [this, endpoints]() {
+        m_backupEndpoints = endpoints;
+    });
+}
+
+void AIScheduler::setHedging(bool enabled, int percentile)
+{
+    QMetaObject::invokeMethod(this, [this, enabled, percentile]() {
+        m_hedgingEnabled = enabled;
+        m_hedgePercentile = percentile;
+    });
+}
+
+void AIScheduler::setRequestsPerMinute(int requestsPerMinute)
+{
+    // 令牌桶只在发送请求的线程中访问
+    QMetaObject::invokeMethod(this, [requestsPerMinute]() {
+        AIClient::setRequestsPerMinute(requestsPerMinute);
+    });
+}
+
+void AIScheduler::warmUp(const AIClient::Endpoint &endpoint)
+{
+    QMetaObject::invokeMethod(this, [this, endpoint]() {
+        const QString key = endpointKey(endpoint.url);
+        AIClient *client = acquireClient(key);
+        client->setApiUrl(endpoint.url);
+        client->setApiKey(endpoint.apiKey);
+        client->setModel(endpoint.model);
+        client->warmUpConnection();
+        releaseClient(client, key);
+    });
+}
+
+void AIScheduler::cancelInThread(RequestId id)
+{
+    for (int i = 0; i < m_queue.size(); ++i) {
+        if (m_queue[i].id == id) {
+            m_queue.removeAt(i);
+            emit requestFinished(id);
+            return;
+        }
+    }
+
+    for (auto it = m_running.begin(); it != m_running.end(); ++it) {
+        if (it->pending.id == id) {
+            // AIClient取消时同步发出requestFinished，由onClientFinished回收并通知调用方
+            it->preempted = false;
+            it.key()->cancelRequest();
+            return;
+        }
+    }
+}
+
+QString AIScheduler::endpointKey(const QString &url)
+{
+    // 同一主机的连接池共享，并发上限按 scheme://host:port 计算
+    QUrl parsed(url);
+    const QString scheme = parsed.scheme().toLower();
+    return QString("%1://%2:%3").arg(scheme, parsed.host()).arg(parsed.port(scheme == "https" ? 443 : 80));
+}
+
+int AIScheduler::runningOn(const QString &key) const
+{
+    int count = 0;
+    for (const Running &running : m_running) {
+        if (running.pending.key == key) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool AIScheduler::preemptBackground(const QString &key)
+{
+    // 抢占最晚提交的后台请求，它已投入的时间最少
+    AIClient *victim = nullptr;
+    RequestId victimId = 0;
+    for (auto it = m_running.cbegin(); it != m_running.cend(); ++it) {
+        if (it->pending.key == key && it->pending.request.priority == Background
+            && !it->preempted && it->pending.id > victimId) {
+            victim = it.key();
+            victimId = it->pending.id;
+        }
+    }
+    if (!victim) {
+        return false;
+    }
+
+    logDebug(lcAI) << "Request" << victimId << "preempted by an interactive request";
+    m_running[victim].preempted = true;
+    victim->cancelRequest();
+    return true;
+}
+
+void AIScheduler::enqueue(const Pending &pending, bool front)
+{
+    // 队列中前台请求整体排在后台请求之前
+    int firstBackground = 0;
+    while (firstBackground < m_queue.size() && m_queue[firstBackground].request.priority == Interactive) {
+        ++firstBackground;
+    }
+
+    int index;
+    if (pending.request.priority == Interactive) {
+        index = front ? 0 : firstBackground;
+    } else {
+        index = front ? firstBackground : m_queue.size();
+    }
+    m_queue.insert(index, pending);
+}
+
+void AIScheduler::scheduleDispatch()
+{
+    // 延后到事件循环中调度，避免在AIClient发出信号的过程中重入
+    if (!m_dispatchScheduled) {
+        m_dispatchScheduled = true;
+        QMetaObject::invokeMethod(this, &AIScheduler::dispatch, Qt::QueuedConnection);
+    }
+}
+
+void AIScheduler::dispatch()
+{
+    m_dispatchScheduled = false;
+
+    for (int i = 0; i < m_queue.size();) {
+        const Pending pending = m_queue[i];
+        bool hasSlot = runningOn(pending.key) < m_maxConcurrentPerEndpoint;
+        if (!hasSlot && pending.request.priority == Interactive) {
+            hasSlot = preemptBackground(pending.key);
+        }
+        if (!hasSlot) {
+            ++i;
+            continue;
+        }
+
+        // 抢占会把后台请求重新排入队列，按句柄定位再取出
+        for (int j = 0; j < m_queue.size(); ++j) {
+            if (m_queue[j].id == pending.id) {
+                m_queue.removeAt(j);
+                break;
+            }
+        }
+        start(pending);
+        i = 0;
+    }
+}
+
+void AIScheduler::start(const Pending &pending)
+{
+    const Request &request = pending.request;
+    const RequestId id = pending.id;
+    AIClient *client = acquireClient(pending.key);
+
+    client->setApiUrl(request.endpoint.url);
+    client->setApiKey(request.endpoint.apiKey);
+    client->setModel(request.endpoint.model);
+    client->setStreaming(request.streaming);
+    client->setMaxRetries(request.maxRetries);
+    client->setRequestTimeout(request.timeoutMs);
+    client->setTools(request.tools);
+    client->setPriority(request.priority == Interactive ? QNetworkRequest::NormalPriority
+                                                        : QNetworkRequest::LowPriority);
+    const bool hedge = request.hedging && m_hedgingEnabled;
+    client->setBackupEndpoints(hedge ? m_backupEndpoints : QList<AIClient::Endpoint>());
+    client->setHedging(hedge, m_hedgePercentile);
+
+    connect(client, &AIClient::responseReceived, this, [this, id](const QString &response) {
+        emit responseReceived(id, response);
+    });
+    connect(client, &AIClient::errorOccurred, this, [this, id](const QString &error) {
+        emit errorOccurred(id, error);
+    });
+    connect(client, &AIClient::partialResponse, this, [this, id](const QString &delta) {
+        emit partialResponse(id, delta);
+    });
+    connect(client, &AIClient::partialReasoning, this, [this, id](const QString &delta) {
+        emit partialReasoning(id, delta);
+    });
+    connect(client, &AIClient::connectionInfo, this, [this, id](bool reused, bool http2) {
+        emit connectionInfo(id, reused, http2);
+    });
+    connect(client, &AIClient::attemptFinished, this,
+            [this, id](int attempt, int httpStatus, qint64 elapsedMs, int retryDelayMs) {
+        emit attemptFinished(id, attempt, httpStatus, elapsedMs, retryDelayMs);
+    });
+    connect(client, &AIClient::requestThrottled, this, [this, id](int waitMs) {
+        emit requestThrottled(id, waitMs);
+    });
+    connect(client, &AIClient::usageReported, this, [this, id](int prompt, int cached, int completion) {
+        emit usageReported(id, prompt, cached, completion);
+    });
+    connect(client, &AIClient::toolCalled, this,
+            [this, id](const QString &name, const QJsonObject &arguments, const QJsonObject &result) {
+        emit toolCalled(id, name, arguments, result);
+    });
+    const bool background = request.priority == Background;
+    connect(client, &AIClient::requestMetrics, this, [this, id, background](RequestMetrics metrics) {
+        metrics.background = background;
+        emit requestMetrics(id, metrics);
+    });
+    connect(client, &AIClient::requestFinished, this, [this, client]() {
+        onClientFinished(client);
+    });
+
+    m_running.insert(client, {pending, false});
+    logDebug(lcAI) << "Request" << id << "started," << runningOn(pending.key) << "running on" << pending.key
+                   << "," << m_queue.size() << "queued";
+
+    // 被抢占后重新发出的请求对调用方而言仍是同一个请求
+    if (!pending.started) {
+        m_running[client].pending.started = true;
+        emit requestStarted(id);
+    }
+    client->sendRequest(request.systemPrompt, request.history, request.userPrompt);
+}
+
+void AIScheduler::onClientFinished(AIClient *client)
+{
+    auto it = m_running.find(client);
+    if (it == m_running.end()) {
+        return;
+    }
+    Running running = it.value();
+    m_running.erase(it);
+    releaseClient(client, running.pending.key);
+
+    if (running.preempted) {
+        enqueue(running.pending, true);
+    } else {
+        emit requestFinished(running.pending.id);
+    }
+    scheduleDispatch();
+}
+
+AIClient *AIScheduler::acquireClient(const QString &key)
+{
+    QList<AIClient *> &idle = m_idleClients[key];
+    return idle.isEmpty() ? new AIClient(this) : idle.takeLast();
+}
+
+void AIScheduler::releaseClient(AIClient *client, const QString &key)
+{
+    disconnect(client, nullptr, this, nullptr);
+
+    QList<AIClient *> &idle = m_idleClients[key];
+    if (idle.size() < MAX_IDLE_CLIENTS_PER_ENDPOINT) {
+        idle.append(client);
+    } else {
+        client->deleteLater();
+    }
+}
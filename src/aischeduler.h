@@ -0,0 +1,106 @@
+#pragma once
+
+#include <QObject>
+#include <QAtomicInteger>
+#include <QHash>
+#include <QList>
+#include "aiclient.h"
+
+// AI请求调度器：多个请求可同时进行，每个请求有独立的句柄、优先级和超时。
+// 同一端点的并发数受限，前台请求排在后台请求之前，名额不足时抢占后台请求
+// （被抢占的请求重新排队，不通知调用方）。结果按句柄通过信号返回。
+// 可以移到独立的网络线程：公开接口可从任意线程调用，实际操作投递到调度器所在线程执行，
+// 响应解析也在该线程完成，调用方经队列连接只收到文本结果。
+class AIScheduler : public QObject {
+    Q_OBJECT
+
+public:
+    using RequestId = quint64; // 0表示无效句柄
+
+    enum Priority {
+        Interactive, // 用户正在等待的请求
+        Background   // 推测预取等可被抢占的请求
+    };
+
+    struct Request {
+        AIClient::Endpoint endpoint;
+        QString systemPrompt;
+        QString userPrompt;
+        QJsonArray history;     // 多轮对话中system与userPrompt之间的历史消息
+        Priority priority = Interactive;
+        int timeoutMs = 0;      // 无响应超时，0表示使用AIClient的默认值
+        int maxRetries = 3;
+        bool streaming = false;
+        bool hedging = true;    // 是否允许使用备用端点对冲
+        QList<AIClient::Tool> tools;
+    };
+
+    explicit AIScheduler(QObject *parent = nullptr);
+
+    // 句柄立即返回；请求在调度器线程中排队
+    RequestId submit(const Request &request);
+    // 取消是异步的，完成后仍会发出requestFinished
+    void cancel(RequestId id);
+    void cancelAll(Priority priority);
+
+    void setMaxConcurrentPerEndpoint(int maxConcurrent);
+    void setBackupEndpoints(const QList<AIClient::Endpoint> &endpoints);
+    void setHedging(bool enabled, int percentile);
+    void setRequestsPerMinute(int requestsPerMinute);
+    void warmUp(const AIClient::Endpoint &endpoint);
+
+signals:
+    void requestStarted(RequestId id);
+    void requestFinished(RequestId id);
+    void responseReceived(RequestId id, const QString &response);
+    void errorOccurred(RequestId id, const QString &error);
+    void partialResponse(RequestId id, const QString &contentDelta);
+    void partialReasoning(RequestId id, const QString &reasoningDelta);
+    void connectionInfo(RequestId id, bool reusedConnection, bool http2);
+    void attemptFinished(RequestId id, int attempt, int httpStatus, qint64 elapsedMs, int retryDelayMs);
+    void requestThrottled(RequestId id, int waitMs);
+    void usageReported(RequestId id, int promptTokens, int cachedPromptTokens, int completionTokens);
+    void toolCalled(RequestId id, const QString &name, const QJsonObject &arguments, const QJsonObject &result);
+    void requestMetrics(RequestId id, const RequestMetrics &metrics);
+
+private slots:
+    void dispatch();
+
+private:
+    struct Pending {
+        RequestId id;
+        QString key;      // 端点的 scheme://host:port
+        Request request;
+        bool started;     // 已向调用方发出requestStarted
+    };
+
+    struct Running {
+        Pending pending;
+        bool preempted;   // 被前台请求抢占，结束后重新排队
+    };
+
+    void cancelInThread(RequestId id);
+    static QString endpointKey(const QString &url);
+    int runningOn(const QString &key) const;
+    bool preemptBackground(const QString &key);
+    void enqueue(const Pending &pending, bool front);
+    void start(const Pending &pending);
+    void onClientFinished(AIClient *client);
+    AIClient *acquireClient(const QString &key);
+    void releaseClient(AIClient *client, const QString &key);
+    void scheduleDispatch();
+
+    QAtomicInteger<quint64> m_nextId;
+    QList<Pending> m_queue;              // 前台请求在前，同优先级先到先发
+    QHash<AIClient *, Running> m_running;
+    QHash<QString, QList<AIClient *>> m_idleClients; // 按端点复用，保留热连接和延迟样本
+    bool m_dispatchScheduled;
+
+    int m_maxConcurrentPerEndpoint;
+    QList<AIClient::Endpoint> m_backupEndpoints;
+    bool m_hedgingEnabled;
+    int m_hedgePercentile;
+
+    static const int DEFAULT_MAX_CONCURRENT_PER_ENDPOINT = 4;
+    static const int MAX_IDLE_CLIENTS_PER_ENDPOINT = 4;
+};
@@ -45,8 +45,104 @@ void AISettings::setupUI()
     m_modelEdit->setPlaceholderText("gpt-3.5-turbo");
     apiLayout->addWidget(m_modelEdit, 2, 1);
     
+    // 流式输出
+    m_streamCheckBox = new QCheckBox("流式输出（边生成边显示，推理模型可先看到思考过程）");
+    apiLayout->addWidget(m_streamCheckBox, 3, 1);
+    
+    // 建议缓存
+    QHBoxLayout *cacheLayout = new QHBoxLayout;
+    m_cacheCheckBox = new QCheckBox("缓存相同局面的AI建议");
+    cacheLayout->addWidget(m_cacheCheckBox);
+    cacheLayout->addStretch();
+    m_clearCacheButton = new QPushButton("清空缓存");
+    connect(m_clearCacheButton, &QPushButton::clicked, this, [this]() {
+        emit clearCacheRequested();
+        QMessageBox::information(this, "缓存", "AI建议缓存已清空");
+    });
+    cacheLayout->addWidget(m_clearCacheButton);
+    apiLayout->addLayout(cacheLayout, 4, 1);
+    
+    // 推测预取
+    QHBoxLayout *speculativeLayout = new QHBoxLayout;
+    m_speculativeCheckBox = new QCheckBox("推测预取下一发后的建议");
+    m_speculativeCheckBox->setToolTip("获得建议后，在后台为下一发对自己打出空包弹的情况提前请求建议，会额外消耗API调用");
+    speculativeLayout->addWidget(m_speculativeCheckBox);
+    speculativeLayout->addStretch();
+    apiLayout->addLayout(speculativeLayout, 5, 1);
+    
+    // 失败重试与请求频率限制
+    QHBoxLayout *retryLayout = new QHBoxLayout;
+    retryLayout->addWidget(new QLabel("失败重试次数:"));
+    m_maxRetriesSpinBox = new QSpinBox;
+    m_maxRetriesSpinBox->setRange(0, 5);
+    m_maxRetriesSpinBox->setToolTip("遇到429、5xx或临时网络错误时自动退避重试，服务端给出Retry-After时按其等待");
+    retryLayout->addWidget(m_maxRetriesSpinBox);
+    retryLayout->addStretch();
+    retryLayout->addWidget(new QLabel("每分钟请求上限:"));
+    m_requestsPerMinuteSpinBox = new QSpinBox;
+    m_requestsPerMinuteSpinBox->setRange(0, 600);
+    m_requestsPerMinuteSpinBox->setSpecialValueText("不限");
+    m_requestsPerMinuteSpinBox->setToolTip("包括推测预取和对冲请求在内，每分钟最多发出的请求数");
+    retryLayout->addWidget(m_requestsPerMinuteSpinBox);
+    retryLayout->addStretch();
+    retryLayout->addWidget(new QLabel("同端点并发:"));
+    m_maxConcurrentSpinBox = new QSpinBox;
+    m_maxConcurrentSpinBox->setRange(1, 8);
+    m_maxConcurrentSpinBox->setToolTip("同一API主机同时进行的请求数上限；名额不足时前台请求会抢占推测预取");
+    retryLayout->addWidget(m_maxConcurrentSpinBox);
+    apiLayout->addLayout(retryLayout, 6, 1);
+    
+    // 紧凑提示词
+    m_compactPromptCheckBox = new QCheckBox("紧凑提示词（精简规则与局面描述，减少输入token）");
+    m_compactPromptCheckBox->setToolTip("系统提示词保持逐字节不变，便于服务端前缀缓存；发送前显示预计token数");
+    apiLayout->addWidget(m_compactPromptCheckBox, 7, 1);
+    
+    // 混合模式
+    m_hybridModeCheckBox = new QCheckBox("混合模式（局面明确时由本地引擎直接作答，不请求AI）");
+    m_hybridModeCheckBox->setToolTip("当前子弹已知、剩余子弹类型单一或期望值差距明显时直接给出本地建议；"
+                                     "期望值接近或持有本地引擎不覆盖的道具时才请求AI");
+    apiLayout->addWidget(m_hybridModeCheckBox, 8, 1);
+    
+    // 工具调用
+    m_toolCallingCheckBox = new QCheckBox("允许AI调用本地概率引擎（需服务支持tools/function calling）");
+    m_toolCallingCheckBox->setToolTip("AI可请求本地计算指定位置的实弹概率、行动期望值和使用道具后的结果分布");
+    apiLayout->addWidget(m_toolCallingCheckBox, 9, 1);
+    
+    // 多轮对话
+    m_conversationCheckBox = new QCheckBox("多轮对话（同一大回合内只发送局面变化）");
+    m_conversationCheckBox->setToolTip("首次请求发送完整局面，之后只发送开枪结果、道具使用和新得知的子弹，并附带精简后的历史对话；"
+                                       "轮次过多时把早期建议折叠为摘要重新开始");
+    apiLayout->addWidget(m_conversationCheckBox, 10, 1);
+    
     mainLayout->addWidget(apiGroup);
     
+    // 备用端点与对冲请求
+    QGroupBox *hedgeGroup = new QGroupBox("备用端点");
+    QVBoxLayout *hedgeLayout = new QVBoxLayout(hedgeGroup);
+    
+    QLabel *endpointsLabel = new QLabel("按优先级每行填写一个备用端点，格式：URL | API Key | 模型");
+    endpointsLabel->setWordWrap(true);
+    hedgeLayout->addWidget(endpointsLabel);
+    
+    m_backupEndpointsEdit = new QPlainTextEdit;
+    m_backupEndpointsEdit->setPlaceholderText("https://api.example.com/v1/chat/completions | sk-... | model-name");
+    m_backupEndpointsEdit->setMaximumHeight(70);
+    hedgeLayout->addWidget(m_backupEndpointsEdit);
+    
+    QHBoxLayout *hedgeOptionsLayout = new QHBoxLayout;
+    m_hedgeCheckBox = new QCheckBox("主端点响应慢时向备用端点发出对冲请求");
+    m_hedgeCheckBox->setToolTip("主端点超过历史首响应延迟的指定分位数仍未响应时，同时请求第一个备用端点，取先返回者");
+    hedgeOptionsLayout->addWidget(m_hedgeCheckBox);
+    hedgeOptionsLayout->addStretch();
+    hedgeOptionsLayout->addWidget(new QLabel("延迟分位数:"));
+    m_hedgePercentileSpinBox = new QSpinBox;
+    m_hedgePercentileSpinBox->setRange(50, 99);
+    m_hedgePercentileSpinBox->setSuffix("%");
+    hedgeOptionsLayout->addWidget(m_hedgePercentileSpinBox);
+    hedgeLayout->addLayout(hedgeOptionsLayout);
+    
+    mainLayout->addWidget(hedgeGroup);
+    
     // 自定义策略组
     QGroupBox *promptGroup = new QGroupBox("自定义策略问题");
     QVBoxLayout *promptLayout = new QVBoxLayout(promptGroup);
@@ -120,6 +216,45 @@ QString AISettings::getCustomPrompt() const
     return m_customPromptEdit->toPlainText().trimmed();
 }
 
+bool AISettings::isStreamEnabled() const
+{
+    return m_streamCheckBox->isChecked();
+}
+
+bool AISettings::isCacheEnabled() const
+{
+    return m_cacheCheckBox->isChecked();
+}
+
+QList<AIClient::Endpoint> AISettings::getBackupEndpoints() const
+{
+    QList<AIClient::Endpoint> endpoints;
+    const QStringList lines = m_backupEndpointsEdit->toPlainText().split('\n');
+    for (const QString &line : lines) {
+        QStringList parts = line.split('|');
+        if (parts.size() < 2 || parts[0].trimmed().isEmpty()) {
+            continue;
+        }
+        endpoints.append({parts[0].trimmed(), parts[1].trimmed(),
+                          parts.size() > 2 ? parts[2].trimmed() : QString()});
+    }
+    return endpoints;
+}
+
+QList<AIClient::Endpoint> AISettings::readBackupEndpoints(QSettings &settings)
+{
+    QList<AIClient::Endpoint> endpoints;
+    int count = settings.beginReadArray("backup_endpoints");
+    for (int i = 0; i < count; ++i) {
+        settings.setArrayIndex(i);
+        endpoints.append({settings.value("url").toString(),
+                          settings.value("api_key").toString(),
+                          settings.value("model").toString()});
+    }
+    settings.endArray();
+    return endpoints;
+}
+
 void AISettings::setApiUrl(const QString &url)
 {
     m_apiUrlEdit->setText(url);
@@ -140,6 +275,16 @@ void AISettings::setCustomPrompt(const QString &prompt)
     m_customPromptEdit->setPlainText(prompt);
 }
 
+void AISettings::setStreamEnabled(bool enabled)
+{
+    m_streamCheckBox->setChecked(enabled);
+}
+
+void AISettings::setCacheEnabled(bool enabled)
+{
+    m_cacheCheckBox->setChecked(enabled);
+}
+
 void AISettings::loadSettings()
 {
     QString defaultUrl = "https://api.openai.com/v1/chat/completions";
@@ -148,6 +293,24 @@ void AISettings::loadSettings()
     m_apiKeyEdit->setText(m_settings->value("api_key", "").toString());
     m_modelEdit->setText(m_settings->value("model", defaultModel).toString());
     m_customPromptEdit->setPlainText(m_settings->value("custom_prompt", "").toString());
+    m_streamCheckBox->setChecked(m_settings->value("stream", false).toBool());
+    m_cacheCheckBox->setChecked(m_settings->value("cache_enabled", true).toBool());
+    m_speculativeCheckBox->setChecked(m_settings->value("speculative_enabled", false).toBool());
+    
+    QStringList endpointLines;
+    for (const auto &endpoint : readBackupEndpoints(*m_settings)) {
+        endpointLines.append(QString("%1 | %2 | %3").arg(endpoint.url, endpoint.apiKey, endpoint.model));
+    }
+    m_backupEndpointsEdit->setPlainText(endpointLines.join('\n'));
+    m_compactPromptCheckBox->setChecked(m_settings->value("compact_prompt", false).toBool());
+    m_hybridModeCheckBox->setChecked(m_settings->value("hybrid_mode", false).toBool());
+    m_toolCallingCheckBox->setChecked(m_settings->value("tool_calling", false).toBool());
+    m_conversationCheckBox->setChecked(m_settings->value("conversation_mode", false).toBool());
+    m_maxRetriesSpinBox->setValue(m_settings->value("max_retries", 3).toInt());
+    m_requestsPerMinuteSpinBox->setValue(m_settings->value("requests_per_minute", 0).toInt());
+    m_maxConcurrentSpinBox->setValue(m_settings->value("max_concurrent", 4).toInt());
+    m_hedgeCheckBox->setChecked(m_settings->value("hedge_enabled", false).toBool());
+    m_hedgePercentileSpinBox->setValue(m_settings->value("hedge_percentile", 90).toInt());
 }
 
 void AISettings::saveSettings()
@@ -156,6 +319,28 @@ void AISettings::saveSettings()
     m_settings->setValue("api_key", getApiKey());
     m_settings->setValue("model", getModel());
     m_settings->setValue("custom_prompt", getCustomPrompt());
+    m_settings->setValue("stream", isStreamEnabled());
+    m_settings->setValue("cache_enabled", isCacheEnabled());
+    m_settings->setValue("speculative_enabled", m_speculativeCheckBox->isChecked());
+    
+    const QList<AIClient::Endpoint> endpoints = getBackupEndpoints();
+    m_settings->beginWriteArray("backup_endpoints", endpoints.size());
+    for (int i = 0; i < endpoints.size(); ++i) {
+        m_settings->setArrayIndex(i);
+        m_settings->setValue("url", endpoints[i].url);
+        m_settings->setValue("api_key", endpoints[i].apiKey);
+        m_settings->setValue("model", endpoints[i].model);
+    }
+    m_settings->endArray();
+    m_settings->setValue("compact_prompt", m_compactPromptCheckBox->isChecked());
+    m_settings->setValue("hybrid_mode", m_hybridModeCheckBox->isChecked());
+    m_settings->setValue("tool_calling", m_toolCallingCheckBox->isChecked());
+    m_settings->setValue("conversation_mode", m_conversationCheckBox->isChecked());
+    m_settings->setValue("max_retries", m_maxRetriesSpinBox->value());
+    m_settings->setValue("requests_per_minute", m_requestsPerMinuteSpinBox->value());
+    m_settings->setValue("max_concurrent", m_maxConcurrentSpinBox->value());
+    m_settings->setValue("hedge_enabled", m_hedgeCheckBox->isChecked());
+    m_settings->setValue("hedge_percentile", m_hedgePercentileSpinBox->value());
     m_settings->sync();
 }
 
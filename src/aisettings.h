@@ -9,7 +9,11 @@
 #include <QGridLayout>
 #include <QLabel>
 #include <QGroupBox>
+#include <QCheckBox>
+#include <QSpinBox>
 #include <QSettings>
+#include <QPlainTextEdit>
+#include "aiclient.h"
 
 class AISettings : public QDialog {
     Q_OBJECT
@@ -21,15 +25,26 @@ public:
     QString getApiKey() const;
     QString getModel() const;
     QString getCustomPrompt() const;
+    bool isStreamEnabled() const;
+    bool isCacheEnabled() const;
+    QList<AIClient::Endpoint> getBackupEndpoints() const;
+    
+    // 备用端点以数组形式保存，MainWindow加载设置时也需要读取
+    static QList<AIClient::Endpoint> readBackupEndpoints(QSettings &settings);
     
     void setApiUrl(const QString &url);
     void setApiKey(const QString &key);
     void setModel(const QString &model);
     void setCustomPrompt(const QString &prompt);
+    void setStreamEnabled(bool enabled);
+    void setCacheEnabled(bool enabled);
     
     void loadSettings();
     void saveSettings();
 
+signals:
+    void clearCacheRequested();
+
 private slots:
     void onAccepted();
     void onRejected();
@@ -40,6 +55,20 @@ private:
     QLineEdit *m_apiUrlEdit;
     QLineEdit *m_apiKeyEdit;
     QLineEdit *m_modelEdit;
+    QCheckBox *m_streamCheckBox;
+    QCheckBox *m_cacheCheckBox;
+    QCheckBox *m_speculativeCheckBox;
+    QSpinBox *m_maxRetriesSpinBox;
+    QCheckBox *m_compactPromptCheckBox;
+    QCheckBox *m_hybridModeCheckBox;
+    QCheckBox *m_toolCallingCheckBox;
+    QCheckBox *m_conversationCheckBox;
+    QSpinBox *m_requestsPerMinuteSpinBox;
+    QSpinBox *m_maxConcurrentSpinBox;
+    QPlainTextEdit *m_backupEndpointsEdit;
+    QCheckBox *m_hedgeCheckBox;
+    QSpinBox *m_hedgePercentileSpinBox;
+    QPushButton *m_clearCacheButton;
     QTextEdit *m_customPromptEdit;
     QPushButton *m_okButton;
     QPushButton *m_cancelButton;
@@ -0,0 +1,152 @@
+#include "batchkernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BRT_HAS_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#else
+#define BRT_HAS_X86 0
+#endif
+
+// GCC/Clang按函数启用AVX2，其余代码仍按基础指令集编译；MSVC无需额外选项即可使用内建函数
+#if BRT_HAS_X86 && (defined(__GNUC__) || defined(__clang__))
+#define BRT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define BRT_TARGET_AVX2
+#endif
+
+namespace {
+// 与Policies::expectedValue相同：射击对手时空包弹有0.1的小惩罚，射击自己时实弹记-2
+constexpr double BLANK_PENALTY = 0.1;
+constexpr double SELF_HIT_PENALTY = 2.0;
+
+bool detectAvx2()
+{
+#if !BRT_HAS_X86
+    return false;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    const bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 0x6) == 0x6;
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5));
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+}
+
+BatchKernels::Isa BatchKernels::bestIsa()
+{
+    static const Isa best = detectAvx2() ? Isa::Avx2 : Isa::Scalar;
+    return best;
+}
+
+bool BatchKernels::supports(Isa isa)
+{
+    return isa == Isa::Scalar || bestIsa() == Isa::Avx2;
+}
+
+const char *BatchKernels::isaName(Isa isa)
+{
+    return isa == Isa::Avx2 ? "avx2" : "scalar";
+}
+
+void BatchKernels::evaluate(const ShellBatch &batch, const ShotBatch &out)
+{
+    evaluate(batch, out, bestIsa());
+}
+
+void BatchKernels::evaluate(const ShellBatch &batch, const ShotBatch &out, Isa isa)
+{
+    if (isa == Isa::Avx2) {
+        evaluateAvx2(batch, out);
+    } else {
+        evaluateScalar(batch, out, 0, batch.count);
+    }
+}
+
+BatchKernels::Shot BatchKernels::evaluate(const Shell &shell)
+{
+    Shot shot;
+    const ShellBatch batch{1, &shell.live, &shell.blank, &shell.knownLiveAhead, &shell.knownBlankAhead,
+                           &shell.current, &shell.opponentHealth, &shell.ownHealth, &shell.damage};
+    const ShotBatch out{&shot.liveProbability, &shot.opponentKillProbability, &shot.selfKillProbability,
+                        &shot.shootOpponentValue, &shot.shootSelfValue};
+    evaluateScalar(batch, out, 0, 1);
+    return shot;
+}
+
+// 运算顺序与AVX2版本一一对应，保证结果逐位相同；先读完输入再写输出，避免可能的别名迫使重复读取
+void BatchKernels::evaluateScalar(const ShellBatch &batch, const ShotBatch &out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; ++i) {
+        const double live = batch.live[i];
+        const double total = live + batch.blank[i];
+        const double knownLive = batch.knownLiveAhead[i];
+        const double unknownTotal = total - knownLive - batch.knownBlankAhead[i];
+        const double current = batch.current[i];
+        const double damage = batch.damage[i];
+        const bool opponentDies = batch.opponentHealth[i] <= damage;
+        const bool selfDies = batch.ownHealth[i] <= damage;
+
+        // 未知位置平分未知的实弹；其余全部已知时只剩实弹与否
+        double p = unknownTotal > 0 ? (live - knownLive) / unknownTotal : (live > 0 ? 1.0 : 0.0);
+        p = current >= 0 ? current : p;
+        p = total > 0 ? p : 0.0;
+
+        out.liveProbability[i] = p;
+        out.opponentKillProbability[i] = opponentDies ? p : 0.0;
+        out.selfKillProbability[i] = selfDies ? p : 0.0;
+        out.shootOpponentValue[i] = p * damage - (1.0 - p) * BLANK_PENALTY;
+        out.shootSelfValue[i] = (1.0 - p) - p * SELF_HIT_PENALTY;
+    }
+}
+
+#if BRT_HAS_X86
+BRT_TARGET_AVX2 void BatchKernels::evaluateAvx2(const ShellBatch &batch, const ShotBatch &out)
+{
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d blankPenalty = _mm256_set1_pd(BLANK_PENALTY);
+    const __m256d selfHitPenalty = _mm256_set1_pd(SELF_HIT_PENALTY);
+
+    size_t i = 0;
+    for (; i + 4 <= batch.count; i += 4) {
+        const __m256d live = _mm256_loadu_pd(batch.live + i);
+        const __m256d total = _mm256_add_pd(live, _mm256_loadu_pd(batch.blank + i));
+        const __m256d knownLive = _mm256_loadu_pd(batch.knownLiveAhead + i);
+        const __m256d unknownLive = _mm256_sub_pd(live, knownLive);
+        const __m256d unknownTotal = _mm256_sub_pd(_mm256_sub_pd(total, knownLive), _mm256_loadu_pd(batch.knownBlankAhead + i));
+
+        // 分母为0的通道先换成1再除，结果随后被掩码替换
+        const __m256d hasUnknown = _mm256_cmp_pd(unknownTotal, zero, _CMP_GT_OQ);
+        const __m256d ratio = _mm256_div_pd(unknownLive, _mm256_blendv_pd(one, unknownTotal, hasUnknown));
+        const __m256d allKnown = _mm256_and_pd(_mm256_cmp_pd(live, zero, _CMP_GT_OQ), one);
+        __m256d p = _mm256_blendv_pd(allKnown, ratio, hasUnknown);
+        const __m256d current = _mm256_loadu_pd(batch.current + i);
+        p = _mm256_blendv_pd(p, current, _mm256_cmp_pd(current, zero, _CMP_GE_OQ));
+        p = _mm256_and_pd(p, _mm256_cmp_pd(total, zero, _CMP_GT_OQ));
+
+        const __m256d damage = _mm256_loadu_pd(batch.damage + i);
+        const __m256d opponentDies = _mm256_cmp_pd(_mm256_loadu_pd(batch.opponentHealth + i), damage, _CMP_LE_OQ);
+        const __m256d selfDies = _mm256_cmp_pd(_mm256_loadu_pd(batch.ownHealth + i), damage, _CMP_LE_OQ);
+        const __m256d blankProbability = _mm256_sub_pd(one, p);
+
+        _mm256_storeu_pd(out.liveProbability + i, p);
+        _mm256_storeu_pd(out.opponentKillProbability + i, _mm256_and_pd(p, opponentDies));
+        _mm256_storeu_pd(out.selfKillProbability + i, _mm256_and_pd(p, selfDies));
+        _mm256_storeu_pd(out.shootOpponentValue + i,
+                         _mm256_sub_pd(_mm256_mul_pd(p, damage), _mm256_mul_pd(blankProbability, blankPenalty)));
+        _mm256_storeu_pd(out.shootSelfValue + i, _mm256_sub_pd(blankProbability, _mm256_mul_pd(p, selfHitPenalty)));
+    }
+    evaluateScalar(batch, out, i, batch.count);
+}
+#else
+void BatchKernels::evaluateAvx2(const ShellBatch &batch, const ShotBatch &out)
+{
+    evaluateScalar(batch, out, 0, batch.count);
+}
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+
+// 子弹概率与一步结局的批量核函数：结构数组（SoA）输入，一次处理大量局面，
+// 供批量分析和模拟使用；单个局面的计算（BulletTracker、DecisionHelper）走同一算法。
+// 运行时检测CPU：支持AVX2时每次处理4个局面，否则使用标量实现，两者结果逐位相同。
+struct ShellBatch {
+    size_t count;
+    const double *live;            // 剩余实弹
+    const double *blank;           // 剩余空包弹
+    const double *knownLiveAhead;  // 当前之后已知的实弹数
+    const double *knownBlankAhead; // 当前之后已知的空包弹数
+    const double *current;         // 当前子弹：1已知实弹，0已知空包弹，-1未知
+    const double *opponentHealth;
+    const double *ownHealth;
+    const double *damage;          // 实弹伤害，手锯生效时为2
+};
+
+struct ShotBatch {
+    double *liveProbability;
+    double *opponentKillProbability; // 射击对手一枪致死的概率
+    double *selfKillProbability;     // 射击自己一枪致死的概率
+    double *shootOpponentValue;      // Policies::expectedValue的一步期望值
+    double *shootSelfValue;
+};
+
+class BatchKernels {
+public:
+    enum class Isa {
+        Scalar,
+        Avx2
+    };
+
+    // 单个局面，字段含义同ShellBatch
+    struct Shell {
+        double live;
+        double blank;
+        double knownLiveAhead = 0;
+        double knownBlankAhead = 0;
+        double current = -1;
+        double opponentHealth = 1;
+        double ownHealth = 1;
+        double damage = 1;
+    };
+
+    struct Shot {
+        double liveProbability;
+        double opponentKillProbability;
+        double selfKillProbability;
+        double shootOpponentValue;
+        double shootSelfValue;
+    };
+
+    static void evaluate(const ShellBatch &batch, const ShotBatch &out);
+    static void evaluate(const ShellBatch &batch, const ShotBatch &out, Isa isa); // isa须受当前CPU支持
+    static Shot evaluate(const Shell &shell);
+
+    static Isa bestIsa();
+    static bool supports(Isa isa);
+    static const char *isaName(Isa isa);
+
+private:
+    static void evaluateScalar(const ShellBatch &batch, const ShotBatch &out, size_t begin, size_t end);
+    static void evaluateAvx2(const ShellBatch &batch, const ShotBatch &out);
+};
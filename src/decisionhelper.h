@@ -2,9 +2,17 @@
 
 #include <QObject>
 #include <QString>
+#include <QHash>
+#include <QElapsedTimer>
+#include <QThread>
 #include "bullettracker.h"
 #include "itemmanager.h"
-#include "aiclient.h"
+#include "aischeduler.h"
+#include "advicecache.h"
+#include "aimetrics.h"
+#include "policytable.h"
+#include "parallelsolver.h"
+#include "batchkernels.h"
 
 class DecisionHelper : public QObject {
     Q_OBJECT
@@ -26,26 +34,67 @@ public:
     };
 
     explicit DecisionHelper(QObject *parent = nullptr);
+    ~DecisionHelper() override;
     
     // 传统本地决策（保留）
     QString getAdvice(const GameState &state);
     double calculateExpectedValue(const GameState &state, bool shootDealer);
+    // 无道具子博弈的精确胜率（编译期求解的静态表，一次查表）；局面不在子博弈内时返回-1
+    double calculateWinProbability(const GameState &state, bool shootDealer);
     
     // AI决策
     void getAIAdvice(const GameState &state, const QString &apiUrl, const QString &apiKey, const QString &model = QString(), const QString &customPrompt = QString());
     void cancelAIRequest();
+    void setStreamingEnabled(bool enabled);
+    void configureAI(const QString &apiUrl, const QString &apiKey, const QString &model = QString());
+    void setCacheEnabled(bool enabled);
+    void setBackupEndpoints(const QList<AIClient::Endpoint> &endpoints, bool hedgingEnabled, int hedgePercentile);
+    void setRetryPolicy(int maxRetries, int requestsPerMinute);
+    // 同一端点同时进行的请求数上限，前台请求优先并可抢占推测预取
+    void setMaxConcurrentRequests(int maxConcurrent);
+    // 紧凑提示词：精简规则、简写局面编码，系统提示词逐字节固定以命中服务端前缀缓存
+    void setCompactPrompt(bool enabled);
+    // 混合模式：本地引擎能明确判断的局面直接作答，只有期望值接近或超出本地模型时才请求AI
+    void setHybridMode(bool enabled);
+    // 工具调用：向模型开放本地概率引擎，模型不必自行推算概率
+    void setToolCallingEnabled(bool enabled);
+    // 多轮对话：同一大回合内首次发送完整局面，之后只发送开枪结果、道具使用、新知子弹等变化
+    void setConversationMode(bool enabled);
+    void resetConversation();
+    
+    // 请求遥测（前台与推测预取请求）
+    const AIMetrics &metrics() const;
+    void clearMetrics();
+    void clearAdviceCache();
+    
+    // 推测预取：玩家思考时，为下一发对自己打出空包弹（仍由玩家行动）的后继局面提前请求建议
+    void setSpeculativePrefetch(bool enabled);
+    void resolveSpeculation(int position, bool isLive);
+    void cancelSpeculation();
 
 signals:
     void aiAdviceReceived(const QString &advice);
+    void aiAdviceDelta(const QString &delta);
+    void aiReasoningDelta(const QString &delta);
     void aiRequestStarted();
     void aiRequestFinished();
     void aiError(const QString &error);
+    void aiConnectionInfo(bool reusedConnection, bool http2);
+    void aiAttemptFinished(int attempt, int httpStatus, qint64 elapsedMs, int retryDelayMs);
+    void aiRequestThrottled(int waitMs);
+    void aiCacheInfo(bool hit, const AdviceCache::Stats &stats);
+    void aiSpeculationInfo(const QString &info);
+    void aiPromptInfo(const QString &info);
+    void aiGatingInfo(const QString &info);
+    void aiToolInfo(const QString &info);
+    void aiMetricsUpdated();
 
 private slots:
     void onAIResponse(const QString &response);
     void onAIError(const QString &error);
     void onAIRequestStarted();
     void onAIRequestFinished();
+    void onAIUsage(int promptTokens, int cachedPromptTokens, int completionTokens);
 
 private:
     QString analyzeCurrentSituation(const GameState &state);
@@ -56,6 +105,156 @@ private:
     QString buildGameInfoPrompt(const GameState &state);
     QString buildSystemPrompt();
     QString buildUserPrompt(const GameState &state, const QString &customPrompt);
+    static QString buildVerboseSystemPrompt();
+    static QString buildVerboseUserPrompt(const GameState &state, const QString &customPrompt);
+    static QString buildCompactSystemPrompt();
+    static QString buildCompactUserPrompt(const GameState &state, const QString &customPrompt);
+    
+    // 本地引擎的判断：decisive为真时advice即为建议，否则reason说明为何需要AI
+    struct LocalVerdict {
+        bool decisive;
+        QString advice;
+        QString reason;
+    };
+    LocalVerdict evaluateLocally(const GameState &state);
+    QString gatingSummary() const;
+    
+    // 本地概率引擎，供工具调用使用；只依赖传入的局面快照
+    static double liveProbabilityAt(const GameState &state, int position);
+    static double expectedValueFor(double liveProbability, bool handsawActive, bool shootDealer);
+    
+    // 当前子弹的实弹概率与两种射击的一步期望值，与BulletTracker同一批量核函数（单个局面）
+    struct ShotOdds {
+        bool currentKnown;
+        bool currentIsLive;
+        BatchKernels::Shot shot;
+    };
+    static ShotOdds evaluateShot(const GameState &state);
+    
+    // 转换为搜索引擎的局面（行动方视角）；子弹过多、持有未建模道具等超出模型范围时返回false
+    static bool toPosition(const GameState &state, Position &position);
+    static QString describeAction(Action action);
+    // 先查内嵌的已解局面表，常见局面无需任何搜索
+    static std::optional<PolicyTable::Answer> probeSolved(const GameState &state);
+    // 表中没有的可建模局面直接搜索，大子树在工作窃取线程池上并行展开；局面过大时不搜索
+    static std::optional<ParallelSolver::Result> searchPosition(const GameState &state);
+    static QJsonObject itemOutcome(const GameState &state, ItemManager::ItemType type);
+    static QList<AIClient::Tool> buildTools(const GameState &state);
+    void onToolCalled(const QString &name, const QJsonObject &arguments);
+    
+    // 规范化局面：与回合内的绝对位置无关，相同局面在不同回合得到相同的键
+    QByteArray canonicalState(const GameState &state, const QString &model, const QString &customPrompt) const;
+    
+    // 两种提示词模式的实测输入token与端到端延迟
+    struct PromptStats {
+        int requests = 0;
+        int usageReports = 0;
+        qint64 promptTokens = 0;
+        qint64 cachedTokens = 0;
+        qint64 latencyMs = 0;
+    };
+    QString promptSummary() const;
+    
+    // 推测预取：分支假设basePosition处的子弹为空包弹，该位置开火后结果不符的分支与预取结果全部作废
+    struct SpeculativeBranch {
+        int basePosition;
+        QByteArray cacheKey;
+        AIScheduler::RequestId request;
+    };
+    struct PrefetchedAdvice {
+        int basePosition;
+        QString advice;
+    };
+    static GameState successorState(const GameState &state, bool isLive);
+    void prefetchSuccessors(const GameState &state);
+    void startSpeculativeBranch(const GameState &state, int basePosition);
+    void finishSpeculativeBranch(AIScheduler::RequestId request, const QString &response, const QString &error);
+    QString speculationSummary() const;
+    
+    // 多轮对话会话，在同一大回合内延续
+    struct Conversation {
+        bool active = false;
+        GameState knownState;       // 模型已知的最新局面
+        QString model;
+        QString customPrompt;
+        bool compact = false;
+        QJsonArray history;         // 交替的user/assistant消息
+        QStringList earlierAdvice;  // 已折叠轮次的建议摘要
+        int deltaTurns = 0;
+    };
+    // 一次前台请求对应的对话轮次，收到回答后才写入会话
+    struct ConversationTurn {
+        bool valid = false;
+        bool fullState = false;     // 开始新会话，发送完整局面
+        GameState state;
+        QString model;
+        QString customPrompt;
+        bool compact = false;
+        QString userPrompt;
+        QJsonArray history;
+        QStringList earlierAdvice;
+    };
+    ConversationTurn prepareConversationTurn(const GameState &state, const QString &model, const QString &customPrompt);
+    void commitConversationTurn(const QString &advice);
+    static bool isSameRound(const GameState &before, const GameState &after);
+    static QString describeStateDelta(const GameState &before, const GameState &after);
+    static QString condenseAdvice(const QString &advice);
+    
+    void cancelForegroundRequest();
+    
+    QThread *m_networkThread;
+    AIScheduler *m_scheduler;   // 运行在m_networkThread中
+    AIScheduler::RequestId m_foregroundRequest; // 0表示没有进行中的前台请求
+    bool m_streaming;
+    int m_maxRetries;
+    AdviceCache m_adviceCache;
+    bool m_cacheEnabled;
+    QByteArray m_pendingCacheKey; // 当前请求完成后写入缓存的键
+    
+    bool m_compactPrompt;
+    bool m_requestCompact;         // 进行中的请求使用的提示词模式
+    QElapsedTimer m_promptTimer;
+    PromptStats m_promptStats[2];  // [0]完整 [1]紧凑
+    QString m_promptEstimate;
+    
+    bool m_hybridMode;
+    quint64 m_localAnswers;  // 本地引擎直接作答、未请求AI的次数
+    quint64 m_gatedToAI;     // 本地无法判断、转交AI的次数
+    
+    // 本地引擎认为两种行动期望值差距低于该值时视为接近，交给AI
+    static constexpr double LOCAL_DECISION_MARGIN = 0.5;
+    // 按子博弈胜率判断时的接近阈值
+    static constexpr double LOCAL_WIN_RATE_MARGIN = 0.05;
+    // 本地搜索的局面规模上限（剩余子弹与道具合计），单核上最坏约0.1秒
+    static constexpr int LOCAL_SEARCH_MAX_WORK = 14;
+    
+    bool m_toolCallingEnabled;
+    quint64 m_toolCalls;
+    
+    bool m_conversationMode;
+    Conversation m_conversation;
+    ConversationTurn m_pendingTurn;
+    static const int MAX_CONVERSATION_DELTAS = 6;   // 增量轮次上限，超过后折叠历史
+    static const int MAX_HISTORY_TOKENS = 2000;
+    static const int MAX_HISTORY_ADVICE_CHARS = 400; // 历史中每条回答保留的字数
+    static const int MAX_SUMMARY_LINES = 4;
+    static const int MAX_SUMMARY_LINE_CHARS = 80;
+    
+    AIMetrics m_metrics;
+    
+    // 最近一次请求的配置，推测请求沿用
+    GameState m_lastState;
+    bool m_hasLastState;
+    QString m_apiUrl;
+    QString m_apiKey;
+    QString m_model;
+    QString m_customPrompt;
     
-    AIClient *m_aiClient;
+    bool m_speculativeEnabled;
+    QList<SpeculativeBranch> m_speculations;
+    QHash<QByteArray, PrefetchedAdvice> m_prefetchedAdvice; // 已完成、尚未被使用的预取结果
+    QByteArray m_attachedSpeculationKey;             // 前台请求正在等待的预取分支
+    quint64 m_speculationsIssued;
+    quint64 m_speculationsUsed;
+    quint64 m_speculationsCancelled;
 };
@@ -0,0 +1,373 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+
+// 不依赖Qt的对局模型，供策略竞技场和本地搜索使用。
+// 局面以行动方视角表示：下标0为行动方，1为对手；胜率均指行动方获胜的概率。
+// 与游戏的差异：双方共享已知子弹信息；逆变器只在当前子弹已确定时使用。
+
+// ItemManager::ItemType中可建模的道具，顺序固定（参与局面编码）
+enum class Item : uint8_t {
+    MagnifyingGlass,
+    Cigarettes,
+    Beer,
+    Handsaw,
+    Handcuffs,
+    BurnerPhone,
+    Inverter,
+    ExpiredMedicine,
+    Count
+};
+
+constexpr int ITEM_KINDS = static_cast<int>(Item::Count);
+
+enum class Action : uint8_t {
+    ShootOpponent,
+    ShootSelf,
+    FirstItem // 之后依次为各道具的使用
+};
+
+constexpr int ACTION_KINDS = static_cast<int>(Action::FirstItem) + ITEM_KINDS;
+
+constexpr Action useItem(Item item)
+{
+    return static_cast<Action>(static_cast<int>(Action::FirstItem) + static_cast<int>(item));
+}
+
+constexpr bool isItemAction(Action action)
+{
+    return action >= Action::FirstItem;
+}
+
+constexpr Item itemOf(Action action)
+{
+    return static_cast<Item>(static_cast<int>(action) - static_cast<int>(Action::FirstItem));
+}
+
+struct Position {
+    static constexpr int MAX_SHELLS = 8;
+    static constexpr int MAX_HEALTH = 7;
+    static constexpr int MAX_ITEM_COUNT = 3; // 每种道具的持有上限
+
+    uint8_t live = 0;
+    uint8_t blank = 0;
+    uint8_t knownMask = 0; // 第i位：从当前起第i发子弹已知
+    uint8_t liveMask = 0;  // 已知子弹中的实弹，是knownMask的子集
+    std::array<uint8_t, 2> health{};
+    uint8_t maxHealth = 0;
+    bool sawActive = false;      // 行动方的手锯已生效
+    bool opponentCuffed = false; // 对手被铐，跳过其下一个回合
+    std::array<std::array<uint8_t, ITEM_KINDS>, 2> items{};
+
+    constexpr int shells() const { return live + blank; }
+    constexpr bool isKnown(int offset) const { return knownMask >> offset & 1; }
+    constexpr bool isKnownLive(int offset) const { return liveMask >> offset & 1; }
+    constexpr int itemCount(int side, Item item) const { return items[side][static_cast<int>(item)]; }
+
+    // 未知位置平分剩余的未知实弹
+    constexpr int unknownLive() const { return live - std::popcount(liveMask); }
+    constexpr int unknownSlots() const { return shells() - std::popcount(knownMask); }
+
+    constexpr double liveProbability(int offset = 0) const
+    {
+        if (isKnown(offset)) {
+            return isKnownLive(offset) ? 1.0 : 0.0;
+        }
+        return unknownSlots() > 0 ? static_cast<double>(unknownLive()) / unknownSlots() : 0.0;
+    }
+
+    // 当前子弹类型已确定（已知或剩余未知子弹同为一种）
+    constexpr bool currentDetermined() const
+    {
+        return isKnown(0) || unknownLive() == 0 || unknownLive() == unknownSlots();
+    }
+
+    // 换成对手视角；手锯和手铐状态在回合交接时已清除
+    constexpr Position flipped() const
+    {
+        Position next = *this;
+        next.health = {health[1], health[0]};
+        next.items = {items[1], items[0]};
+        next.sawActive = false;
+        next.opponentCuffed = false;
+        return next;
+    }
+
+    // 规范键：无损打包为64位，相同局面与回合内位置、双方座次无关
+    // [0,4)实弹 [4,8)空包弹 [8,21)已知子弹三进制 [21,30)双方血量与上限 30手锯 31手铐 [32,64)双方道具各2位
+    constexpr uint64_t key() const
+    {
+        uint64_t known = 0;
+        for (int offset = MAX_SHELLS - 1; offset >= 0; --offset) {
+            known = known * 3 + (isKnown(offset) ? (isKnownLive(offset) ? 2 : 1) : 0);
+        }
+        uint64_t packed = live | uint64_t(blank) << 4 | known << 8
+                        | uint64_t(health[0]) << 21 | uint64_t(health[1]) << 24 | uint64_t(maxHealth) << 27
+                        | uint64_t(sawActive) << 30 | uint64_t(opponentCuffed) << 31;
+        for (int side = 0; side < 2; ++side) {
+            for (int item = 0; item < ITEM_KINDS; ++item) {
+                packed |= uint64_t(items[side][item]) << (32 + side * 16 + item * 2);
+            }
+        }
+        return packed;
+    }
+
+    static constexpr Position fromKey(uint64_t key)
+    {
+        Position position;
+        position.live = key & 0xF;
+        position.blank = key >> 4 & 0xF;
+        uint64_t known = key >> 8 & 0x1FFF;
+        for (int offset = 0; offset < MAX_SHELLS; ++offset, known /= 3) {
+            if (known % 3 != 0) {
+                position.knownMask |= 1 << offset;
+                position.liveMask |= (known % 3 == 2 ? 1 : 0) << offset;
+            }
+        }
+        position.health = {static_cast<uint8_t>(key >> 21 & 7), static_cast<uint8_t>(key >> 24 & 7)};
+        position.maxHealth = key >> 27 & 7;
+        position.sawActive = key >> 30 & 1;
+        position.opponentCuffed = key >> 31 & 1;
+        for (int side = 0; side < 2; ++side) {
+            for (int item = 0; item < ITEM_KINDS; ++item) {
+                position.items[side][item] = key >> (32 + side * 16 + item * 2) & 3;
+            }
+        }
+        return position;
+    }
+
+    friend constexpr bool operator==(const Position &, const Position &) = default;
+};
+
+// 一次行动的结局；result不为Continue时next保持行动方视角，否则为下一行动方视角
+struct Outcome {
+    enum Result : uint8_t {
+        Continue,
+        Win,       // 行动方获胜
+        Loss,      // 行动方落败
+        RoundOver  // 子弹打完、双方存活，等待重新装弹
+    };
+
+    double probability = 0.0;
+    Position next;
+    Result result = Continue;
+    bool turnPassed = false;
+    bool shellLive = false;     // 射出、弹出或查看到的子弹类型
+    int8_t revealed = -1;       // 一次性电话查看的偏移
+    bool medicineHealed = false;
+};
+
+class GameRules {
+public:
+    static constexpr int MAX_OUTCOMES = 2 * (Position::MAX_SHELLS - 1);
+
+    // 有意义的行动：排除不改变局面或被模型排除的道具使用
+    static constexpr bool isLegal(const Position &position, Action action)
+    {
+        if (position.shells() <= 0) {
+            return false;
+        }
+        if (!isItemAction(action)) {
+            return true;
+        }
+        const Item item = itemOf(action);
+        if (position.itemCount(0, item) <= 0) {
+            return false;
+        }
+        switch (item) {
+        case Item::MagnifyingGlass:
+            return !position.currentDetermined();
+        case Item::Cigarettes:
+            return position.health[0] < position.maxHealth;
+        case Item::Handsaw:
+            return !position.sawActive;
+        case Item::Handcuffs:
+            return !position.opponentCuffed;
+        case Item::BurnerPhone:
+            return position.shells() >= 2;
+        case Item::Inverter:
+            return position.currentDetermined();
+        default:
+            return true;
+        }
+    }
+
+    // 列出行动的全部机会结局（概率为0的结局不列出），返回个数
+    static constexpr int outcomes(const Position &position, Action action, Outcome *out)
+    {
+        int count = 0;
+        const double liveProbability = position.liveProbability();
+
+        if (!isItemAction(action)) {
+            const bool atSelf = action == Action::ShootSelf;
+            for (bool isLive : {true, false}) {
+                const double probability = isLive ? liveProbability : 1.0 - liveProbability;
+                if (probability > 0.0) {
+                    out[count++] = shoot(position, atSelf, isLive, probability);
+                }
+            }
+            return count;
+        }
+
+        Position next = position;
+        --next.items[0][static_cast<int>(itemOf(action))];
+        switch (itemOf(action)) {
+        case Item::MagnifyingGlass:
+            for (bool isLive : {true, false}) {
+                const double probability = isLive ? liveProbability : 1.0 - liveProbability;
+                if (probability > 0.0) {
+                    Outcome outcome = stay(next, probability);
+                    outcome.next.knownMask |= 1;
+                    outcome.next.liveMask |= isLive ? 1 : 0;
+                    outcome.shellLive = isLive;
+                    outcome.revealed = 0;
+                    out[count++] = outcome;
+                }
+            }
+            break;
+        case Item::Cigarettes:
+            next.health[0] = next.health[0] + 1 < next.maxHealth ? next.health[0] + 1 : next.maxHealth;
+            out[count++] = stay(next, 1.0);
+            break;
+        case Item::Beer:
+            for (bool isLive : {true, false}) {
+                const double probability = isLive ? liveProbability : 1.0 - liveProbability;
+                if (probability > 0.0) {
+                    Outcome outcome = stay(next, probability);
+                    consumeShell(outcome.next, isLive);
+                    outcome.shellLive = isLive;
+                    if (outcome.next.shells() == 0) {
+                        outcome.result = Outcome::RoundOver;
+                    }
+                    out[count++] = outcome;
+                }
+            }
+            break;
+        case Item::Handsaw:
+            next.sawActive = true;
+            out[count++] = stay(next, 1.0);
+            break;
+        case Item::Handcuffs:
+            next.opponentCuffed = true;
+            out[count++] = stay(next, 1.0);
+            break;
+        case Item::BurnerPhone: {
+            // 随机查看当前之后的某一发；已知的位置不带来新信息
+            const double pick = 1.0 / (position.shells() - 1);
+            for (int offset = 1; offset < position.shells(); ++offset) {
+                if (position.isKnown(offset)) {
+                    Outcome outcome = stay(next, pick);
+                    outcome.shellLive = position.isKnownLive(offset);
+                    outcome.revealed = static_cast<int8_t>(offset);
+                    out[count++] = outcome;
+                    continue;
+                }
+                for (bool isLive : {true, false}) {
+                    const double probability = pick * (isLive ? position.liveProbability(offset)
+                                                              : 1.0 - position.liveProbability(offset));
+                    if (probability > 0.0) {
+                        Outcome outcome = stay(next, probability);
+                        outcome.next.knownMask |= 1 << offset;
+                        outcome.next.liveMask |= (isLive ? 1 : 0) << offset;
+                        outcome.shellLive = isLive;
+                        outcome.revealed = static_cast<int8_t>(offset);
+                        out[count++] = outcome;
+                    }
+                }
+            }
+            break;
+        }
+        case Item::Inverter: {
+            const bool wasLive = liveProbability > 0.5;
+            next.knownMask |= 1;
+            next.liveMask = static_cast<uint8_t>((next.liveMask & ~1) | (wasLive ? 0 : 1));
+            next.live += wasLive ? -1 : 1;
+            next.blank += wasLive ? 1 : -1;
+            Outcome outcome = stay(next, 1.0);
+            outcome.shellLive = !wasLive;
+            out[count++] = outcome;
+            break;
+        }
+        case Item::ExpiredMedicine: {
+            // 50%回复2点，50%失去1点
+            Outcome healed = stay(next, 0.5);
+            healed.next.health[0] = next.health[0] + 2 < next.maxHealth ? next.health[0] + 2 : next.maxHealth;
+            healed.medicineHealed = true;
+            out[count++] = healed;
+            Outcome hurt = stay(next, 0.5);
+            hurt.next.health[0] = next.health[0] - 1;
+            if (hurt.next.health[0] == 0) {
+                hurt.result = Outcome::Loss;
+            }
+            out[count++] = hurt;
+            break;
+        }
+        default:
+            break;
+        }
+        return count;
+    }
+
+    // 子弹打完而双方存活时的局面估值（行动方视角），按剩余血量比例
+    static constexpr double roundOverValue(int ownHealth, int opponentHealth)
+    {
+        return static_cast<double>(ownHealth) / (ownHealth + opponentHealth);
+    }
+
+private:
+    static constexpr Outcome stay(const Position &next, double probability)
+    {
+        Outcome outcome;
+        outcome.probability = probability;
+        outcome.next = next;
+        return outcome;
+    }
+
+    static constexpr void consumeShell(Position &position, bool isLive)
+    {
+        if (isLive) {
+            --position.live;
+        } else {
+            --position.blank;
+        }
+        position.knownMask >>= 1;
+        position.liveMask >>= 1;
+    }
+
+    static constexpr Outcome shoot(const Position &position, bool atSelf, bool isLive, double probability)
+    {
+        Outcome outcome = stay(position, probability);
+        Position &next = outcome.next;
+        consumeShell(next, isLive);
+        next.sawActive = false;
+        outcome.shellLive = isLive;
+
+        if (isLive) {
+            const int victim = atSelf ? 0 : 1;
+            const int damage = position.sawActive ? 2 : 1;
+            next.health[victim] = next.health[victim] > damage ? next.health[victim] - damage : 0;
+            if (next.health[victim] == 0) {
+                outcome.result = atSelf ? Outcome::Loss : Outcome::Win;
+                return outcome;
+            }
+        }
+        if (next.shells() == 0) {
+            outcome.result = Outcome::RoundOver;
+            return outcome;
+        }
+
+        // 向自己打出空包弹保留回合；对手被铐时跳过其回合
+        if (atSelf && !isLive) {
+            return outcome;
+        }
+        if (next.opponentCuffed) {
+            next.opponentCuffed = false;
+            return outcome;
+        }
+        next = next.flipped();
+        outcome.turnPassed = true;
+        return outcome;
+    }
+};
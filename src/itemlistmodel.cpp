@@ -0,0 +1,160 @@
+#include "itemlistmodel.h"
+#include <QPainter>
+#include <QMouseEvent>
+#include <QHelpEvent>
+#include <QAbstractItemView>
+#include <QToolTip>
+#include <QColor>
+#include <QFont>
+
+// ItemListModel实现
+ItemListModel::ItemListModel(ItemManager *itemManager, bool isPlayer, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_itemManager(itemManager)
+    , m_isPlayer(isPlayer)
+    , m_rowCount(0)
+{
+    m_rowCount = items().size();
+
+    connect(m_itemManager, &ItemManager::itemAdded, this, &ItemListModel::onItemAdded);
+    connect(m_itemManager, &ItemManager::itemChanged, this, &ItemListModel::onItemChanged);
+    connect(m_itemManager, &ItemManager::itemRemoved, this, &ItemListModel::onItemRemoved);
+    connect(m_itemManager, &ItemManager::itemsCleared, this, &ItemListModel::onItemsCleared);
+}
+
+int ItemListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_rowCount;
+}
+
+QVariant ItemListModel::data(const QModelIndex &index, int role) const
+{
+    const auto &list = items();
+    if (!index.isValid() || index.row() >= list.size()) {
+        return QVariant();
+    }
+
+    const auto &item = list[index.row()];
+    switch (role) {
+    case Qt::DisplayRole:
+        return item.isUsed ? item.name + " (已使用)" : item.name;
+    case Qt::ToolTipRole:
+        return item.description;
+    case Qt::ForegroundRole:
+        if (item.isUsed) {
+            return QColor(Qt::gray);
+        }
+        return m_isPlayer ? QColor(Qt::darkGreen) : QColor(Qt::darkRed);
+    case Qt::FontRole: {
+        QFont font;
+        font.setBold(!item.isUsed);
+        font.setStrikeOut(item.isUsed);
+        return font;
+    }
+    default:
+        return QVariant();
+    }
+}
+
+void ItemListModel::onItemAdded(bool isPlayer, ItemManager::ItemType type)
+{
+    Q_UNUSED(type);
+    if (isPlayer != m_isPlayer) return;
+
+    // 新道具总是追加在末尾
+    int first = m_rowCount;
+    int last = items().size() - 1;
+    if (last < first) return;
+
+    beginInsertRows(QModelIndex(), first, last);
+    m_rowCount = last + 1;
+    endInsertRows();
+}
+
+void ItemListModel::onItemChanged(bool isPlayer, int index)
+{
+    if (isPlayer != m_isPlayer || index < 0 || index >= m_rowCount) return;
+
+    QModelIndex changed = this->index(index);
+    emit dataChanged(changed, changed);
+}
+
+void ItemListModel::onItemRemoved(bool isPlayer, int index)
+{
+    if (isPlayer != m_isPlayer || index < 0 || index >= m_rowCount) return;
+
+    beginRemoveRows(QModelIndex(), index, index);
+    --m_rowCount;
+    endRemoveRows();
+}
+
+void ItemListModel::onItemsCleared()
+{
+    if (m_rowCount == 0) return;
+
+    beginRemoveRows(QModelIndex(), 0, m_rowCount - 1);
+    m_rowCount = 0;
+    endRemoveRows();
+}
+
+const QList<ItemManager::ItemInfo>& ItemListModel::items() const
+{
+    return m_isPlayer ? m_itemManager->getPlayerItems() : m_itemManager->getDealerItems();
+}
+
+// ItemListDelegate实现
+ItemListDelegate::ItemListDelegate(QObject *parent)
+    : QStyledItemDelegate(parent)
+{
+}
+
+void ItemListDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    // 名称部分交给默认绘制，右侧留出删除标记的位置
+    QStyleOptionViewItem textOption(option);
+    textOption.rect.adjust(ITEM_MARGIN, 0, -(DELETE_BUTTON_SIZE + ITEM_MARGIN * 2), 0);
+    QStyledItemDelegate::paint(painter, textOption, index);
+
+    painter->save();
+    QFont font = option.font;
+    font.setPixelSize(12);
+    painter->setFont(font);
+    painter->drawText(deleteButtonRect(option.rect), Qt::AlignCenter, "❌");
+    painter->restore();
+}
+
+QSize ItemListDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+    QSize size = QStyledItemDelegate::sizeHint(option, index);
+    size.setWidth(size.width() + DELETE_BUTTON_SIZE + ITEM_MARGIN * 3);
+    size.setHeight(qMax(size.height(), DELETE_BUTTON_SIZE + 4));
+    return size;
+}
+
+bool ItemListDelegate::editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    if (event->type() == QEvent::MouseButtonRelease) {
+        auto *mouseEvent = static_cast<QMouseEvent *>(event);
+        if (mouseEvent->button() == Qt::LeftButton
+            && deleteButtonRect(option.rect).contains(mouseEvent->pos())) {
+            emit deleteRequested(index.row());
+            return true;
+        }
+    }
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
+
+bool ItemListDelegate::helpEvent(QHelpEvent *event, QAbstractItemView *view, const QStyleOptionViewItem &option, const QModelIndex &index)
+{
+    if (event->type() == QEvent::ToolTip && deleteButtonRect(option.rect).contains(event->pos())) {
+        QToolTip::showText(event->globalPos(), "删除此道具", view);
+        return true;
+    }
+    return QStyledItemDelegate::helpEvent(event, view, option, index);
+}
+
+QRect ItemListDelegate::deleteButtonRect(const QRect &itemRect)
+{
+    int top = itemRect.top() + (itemRect.height() - DELETE_BUTTON_SIZE) / 2;
+    return QRect(itemRect.right() - ITEM_MARGIN - DELETE_BUTTON_SIZE, top, DELETE_BUTTON_SIZE, DELETE_BUTTON_SIZE);
+}
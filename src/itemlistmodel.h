@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QStyledItemDelegate>
+#include "itemmanager.h"
+
+// 道具列表模型：直接读取ItemManager中的数据，只对插入/删除的行发出增量通知
+class ItemListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    ItemListModel(ItemManager *itemManager, bool isPlayer, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private slots:
+    void onItemAdded(bool isPlayer, ItemManager::ItemType type);
+    void onItemChanged(bool isPlayer, int index);
+    void onItemRemoved(bool isPlayer, int index);
+    void onItemsCleared();
+
+private:
+    const QList<ItemManager::ItemInfo>& items() const;
+
+    ItemManager *m_itemManager;
+    bool m_isPlayer;
+    int m_rowCount; // 视图所见的行数，与ItemManager的增删通知同步
+};
+
+// 道具列表委托：绘制道具名称和删除标记，并对删除标记做点击检测，不为每行创建控件
+class ItemListDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+public:
+    explicit ItemListDelegate(QObject *parent = nullptr);
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    bool editorEvent(QEvent *event, QAbstractItemModel *model, const QStyleOptionViewItem &option, const QModelIndex &index) override;
+    bool helpEvent(QHelpEvent *event, QAbstractItemView *view, const QStyleOptionViewItem &option, const QModelIndex &index) override;
+
+signals:
+    void deleteRequested(int row);
+
+private:
+    static QRect deleteButtonRect(const QRect &itemRect);
+
+    static const int DELETE_BUTTON_SIZE = 25;
+    static const int ITEM_MARGIN = 5;
+};
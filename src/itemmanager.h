@@ -48,6 +48,9 @@ public:
 signals:
     void itemAdded(bool isPlayer, ItemType type);
     void itemUsed(bool isPlayer, ItemType type);
+    void itemChanged(bool isPlayer, int index);
+    void itemRemoved(bool isPlayer, int index);
+    void itemsCleared();
 
 private:
     QList<ItemInfo> m_playerItems;
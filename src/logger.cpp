@@ -0,0 +1,263 @@
+#include "logger.h"
+#include <QDateTime>
+#include <QFileInfo>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+Q_LOGGING_CATEGORY(lcApp, "app")
+Q_LOGGING_CATEGORY(lcTracker, "tracker")
+Q_LOGGING_CATEGORY(lcDecision, "decision")
+Q_LOGGING_CATEGORY(lcAI, "ai")
+
+Logger &Logger::instance()
+{
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger()
+    : m_slots(new Slot[CAPACITY])
+    , m_enqueuePos(0)
+    , m_dequeuePos(0)
+    , m_dropped(0)
+    , m_written(0)
+    , m_running(false)
+    , m_maxFileSize(0)
+    , m_maxBackupFiles(0)
+    , m_reportedDropped(0)
+{
+    for (size_t i = 0; i < CAPACITY; ++i) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+Logger::~Logger()
+{
+    stop();
+}
+
+bool Logger::start(const QString &filePath, qint64 maxFileSize, int maxBackupFiles)
+{
+    if (m_running.load()) {
+        return true;
+    }
+
+    m_filePath = filePath;
+    m_maxFileSize = maxFileSize;
+    m_maxBackupFiles = maxBackupFiles;
+
+    // 追加写入，超出大小时才轮转，不再每次启动清空
+    if (QFileInfo(m_filePath).size() >= m_maxFileSize) {
+        rotateFiles();
+    }
+    m_file.setFileName(m_filePath);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        return false;
+    }
+
+    m_running.store(true);
+    m_writerThread = std::thread(&Logger::writerLoop, this);
+    return true;
+}
+
+void Logger::stop()
+{
+    if (!m_running.exchange(false)) {
+        return;
+    }
+
+    m_wakeCondition.notify_one();
+    if (m_writerThread.joinable()) {
+        m_writerThread.join();
+    }
+    m_file.close();
+}
+
+void Logger::flush()
+{
+    if (!m_running.load()) {
+        return;
+    }
+
+    // 等待写线程追上当前已入队的位置
+    const quint64 target = m_enqueuePos.load(std::memory_order_acquire);
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (m_written.load(std::memory_order_acquire) < target
+           && std::chrono::steady_clock::now() < deadline) {
+        m_wakeCondition.notify_one();
+        std::this_thread::yield();
+    }
+}
+
+quint64 Logger::droppedCount() const
+{
+    return m_dropped.load(std::memory_order_relaxed);
+}
+
+void Logger::messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
+{
+    Logger &logger = instance();
+    Entry entry{QDateTime::currentMSecsSinceEpoch(), type,
+                context.category ? context.category : "default", msg};
+
+    if (!logger.m_running.load(std::memory_order_relaxed)) {
+        std::fputs(formatEntry(entry).constData(), stderr);
+        return;
+    }
+
+    if (!logger.tryPush(std::move(entry))) {
+        logger.m_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (type == QtFatalMsg) {
+        // 进程即将终止，同步等待缓冲区写出
+        logger.flush();
+    } else {
+        logger.m_wakeCondition.notify_one();
+    }
+}
+
+bool Logger::tryPush(Entry &&entry)
+{
+    const size_t mask = CAPACITY - 1;
+    size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+    Slot *slot = nullptr;
+
+    for (;;) {
+        slot = &m_slots[pos & mask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false; // 缓冲区已满
+        } else {
+            pos = m_enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->entry = std::move(entry);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool Logger::tryPop(Entry &entry)
+{
+    const size_t mask = CAPACITY - 1;
+    size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+    Slot *slot = &m_slots[pos & mask];
+
+    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1) < 0) {
+        return false; // 缓冲区为空（或生产者尚未写完该槽位）
+    }
+
+    // 只有写线程一个消费者，无需CAS
+    m_dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    entry = std::move(slot->entry);
+    slot->entry.message = QString();
+    slot->sequence.store(pos + CAPACITY, std::memory_order_release);
+    return true;
+}
+
+void Logger::writerLoop()
+{
+    QByteArray batch;
+    Entry entry;
+
+    for (;;) {
+        int count = 0;
+        while (count < BATCH_LIMIT && tryPop(entry)) {
+            batch += formatEntry(entry);
+            ++count;
+        }
+
+        quint64 dropped = m_dropped.load(std::memory_order_relaxed);
+        if (dropped != m_reportedDropped) {
+            Entry notice{QDateTime::currentMSecsSinceEpoch(), QtWarningMsg, "logger",
+                         QString("日志缓冲区溢出，丢弃了 %1 条消息（累计 %2 条）")
+                             .arg(dropped - m_reportedDropped).arg(dropped)};
+            batch += formatEntry(notice);
+            m_reportedDropped = dropped;
+        }
+
+        if (!batch.isEmpty()) {
+            writeBatch(batch);
+            batch.clear();
+            m_written.fetch_add(count, std::memory_order_release);
+        }
+
+        if (count == BATCH_LIMIT) {
+            continue; // 仍有积压，继续排空
+        }
+
+        if (!m_running.load()) {
+            // 退出前排空剩余消息
+            if (m_dequeuePos.load(std::memory_order_relaxed) == m_enqueuePos.load(std::memory_order_relaxed)) {
+                break;
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_wakeMutex);
+        m_wakeCondition.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS));
+    }
+}
+
+void Logger::writeBatch(const QByteArray &batch)
+{
+    m_file.write(batch);
+    m_file.flush();
+
+    if (m_maxFileSize > 0 && m_file.size() >= m_maxFileSize) {
+        m_file.close();
+        rotateFiles();
+        m_file.setFileName(m_filePath);
+        m_file.open(QIODevice::WriteOnly | QIODevice::Append);
+    }
+}
+
+void Logger::rotateFiles()
+{
+    // debug.log -> debug.log.1 -> ... -> debug.log.N，最旧的被删除
+    QFile::remove(QString("%1.%2").arg(m_filePath).arg(m_maxBackupFiles));
+    for (int i = m_maxBackupFiles - 1; i >= 1; --i) {
+        QFile::rename(QString("%1.%2").arg(m_filePath).arg(i),
+                      QString("%1.%2").arg(m_filePath).arg(i + 1));
+    }
+    if (m_maxBackupFiles > 0) {
+        QFile::rename(m_filePath, m_filePath + ".1");
+    } else {
+        QFile::remove(m_filePath);
+    }
+}
+
+QByteArray Logger::formatEntry(const Entry &entry)
+{
+    const char *level = "Debug";
+    switch (entry.type) {
+    case QtDebugMsg:
+        level = "Debug";
+        break;
+    case QtInfoMsg:
+        level = "Info";
+        break;
+    case QtWarningMsg:
+        level = "Warning";
+        break;
+    case QtCriticalMsg:
+        level = "Critical";
+        break;
+    case QtFatalMsg:
+        level = "Fatal";
+        break;
+    }
+
+    QString time = QDateTime::fromMSecsSinceEpoch(entry.timestamp).toString("yyyy-MM-dd hh:mm:ss.zzz");
+    return QString("[%1] %2 (%3): %4\n")
+        .arg(time, QLatin1String(level), QLatin1String(entry.category), entry.message)
+        .toUtf8();
+}
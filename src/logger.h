@@ -0,0 +1,100 @@
+#pragma once
+
+#include <QtGlobal>
+#include <QLoggingCategory>
+#include <QString>
+#include <QFile>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+Q_DECLARE_LOGGING_CATEGORY(lcApp)
+Q_DECLARE_LOGGING_CATEGORY(lcTracker)
+Q_DECLARE_LOGGING_CATEGORY(lcDecision)
+Q_DECLARE_LOGGING_CATEGORY(lcAI)
+
+// 编译期日志级别阈值：0=Trace 1=Debug 2=Info 3=Warning 4=Critical
+// 低于阈值的日志语句条件恒为假，连同参数求值一起被编译消除
+#ifndef BRT_LOG_LEVEL
+#  ifdef NDEBUG
+#    define BRT_LOG_LEVEL 2
+#  else
+#    define BRT_LOG_LEVEL 1
+#  endif
+#endif
+
+// 写成只执行一次的for循环（与qCDebug相同的写法），展开后是一条完整语句，
+// 调用处的else不会与宏内部的条件配对
+#define BRT_LOG_IF(level, stream) \
+    for (bool brtLogEnabled = BRT_LOG_LEVEL <= (level); brtLogEnabled; brtLogEnabled = false) stream
+
+// Trace用于完整的请求/响应正文等大块内容，默认不编译
+#define logTrace(category)    BRT_LOG_IF(0, qCDebug(category))
+#define logDebug(category)    BRT_LOG_IF(1, qCDebug(category))
+#define logInfo(category)     BRT_LOG_IF(2, qCInfo(category))
+#define logWarning(category)  BRT_LOG_IF(3, qCWarning(category))
+#define logCritical(category) BRT_LOG_IF(4, qCCritical(category))
+
+// 异步日志：消息处理函数只把消息放入无锁多生产者环形缓冲区，
+// 由后台写线程批量格式化并写入文件，文件按大小轮转
+class Logger {
+public:
+    static Logger &instance();
+
+    bool start(const QString &filePath, qint64 maxFileSize = 4 * 1024 * 1024, int maxBackupFiles = 3);
+    void stop();
+    void flush();
+
+    quint64 droppedCount() const;
+
+    static void messageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg);
+
+private:
+    struct Entry {
+        qint64 timestamp;
+        QtMsgType type;
+        const char *category;
+        QString message;
+    };
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        Entry entry;
+    };
+
+    Logger();
+    ~Logger();
+    Logger(const Logger &) = delete;
+    Logger &operator=(const Logger &) = delete;
+
+    bool tryPush(Entry &&entry);
+    bool tryPop(Entry &entry);
+    void writerLoop();
+    void writeBatch(const QByteArray &batch);
+    void rotateFiles();
+    static QByteArray formatEntry(const Entry &entry);
+
+    static const size_t CAPACITY = 8192;   // 必须是2的幂
+    static const int BATCH_LIMIT = 512;
+    static const int FLUSH_INTERVAL_MS = 100;
+
+    std::unique_ptr<Slot[]> m_slots;
+    alignas(64) std::atomic<size_t> m_enqueuePos;
+    alignas(64) std::atomic<size_t> m_dequeuePos;
+    alignas(64) std::atomic<quint64> m_dropped;
+    std::atomic<quint64> m_written;
+    std::atomic<bool> m_running;
+
+    std::thread m_writerThread;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+
+    // 以下成员只在写线程中访问
+    QFile m_file;
+    QString m_filePath;
+    qint64 m_maxFileSize;
+    int m_maxBackupFiles;
+    quint64 m_reportedDropped;
+};
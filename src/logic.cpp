@@ -1,7 +1,16 @@
 #include "bullettracker.h"
 #include "itemmanager.h"
 #include "decisionhelper.h"
+#include "batchkernels.h"
+#include "policies.h"
+#include "shottable.h"
 #include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QMap>
+#include "logger.h"
+#include "tracer.h"
+#include <algorithm>
 
 // BulletTracker实现
 BulletTracker::BulletTracker(QObject *parent)
@@ -32,6 +41,8 @@ void BulletTracker::startNewRound(int liveBullets, int blankBullets)
 
 void BulletTracker::fireBullet(bool isLive)
 {
+    TRACE_SCOPE("BulletTracker::fireBullet");
+    
     if (m_remainingLive + m_remainingBlank <= 0) {
         return; // 没有剩余子弹
     }
@@ -153,46 +164,22 @@ const QList<BulletTracker::BulletInfo>& BulletTracker::getKnownBullets() const
 
 void BulletTracker::calculateProbability()
 {
-    int totalRemaining = m_remainingLive + m_remainingBlank;
-    
-    if (totalRemaining <= 0) {
-        m_liveProbability = 0.0;
-        emit probabilityChanged(m_liveProbability);
-        return;
-    }
-    
-    // 检查当前位置是否已知
+    // 与DecisionHelper、批量分析使用同一核函数
+    BatchKernels::Shell shell{static_cast<double>(m_remainingLive), static_cast<double>(m_remainingBlank)};
     for (const auto &known : m_knownBullets) {
-        if (known.position == m_currentPosition && !known.isFired) {
-            m_liveProbability = known.isLive ? 1.0 : 0.0;
-            emit probabilityChanged(m_liveProbability);
-            return;
+        if (known.isFired || known.position < m_currentPosition) {
+            continue;
         }
-    }
-    
-    // 基础概率计算
-    int adjustedLive = m_remainingLive;
-    int adjustedBlank = m_remainingBlank;
-    
-    // 减去已知但未发射的子弹
-    for (const auto &known : m_knownBullets) {
-        if (!known.isFired && known.position > m_currentPosition) {
-            if (known.isLive) {
-                adjustedLive = qMax(0, adjustedLive - 1);
-            } else {
-                adjustedBlank = qMax(0, adjustedBlank - 1);
-            }
+        if (known.position == m_currentPosition) {
+            shell.current = known.isLive ? 1.0 : 0.0;
+        } else if (known.isLive) {
+            shell.knownLiveAhead = qMin(shell.knownLiveAhead + 1, shell.live);
+        } else {
+            shell.knownBlankAhead = qMin(shell.knownBlankAhead + 1, shell.blank);
         }
     }
     
-    int adjustedTotal = adjustedLive + adjustedBlank;
-    
-    if (adjustedTotal <= 0) {
-        m_liveProbability = m_remainingLive > 0 ? 1.0 : 0.0;
-    } else {
-        m_liveProbability = static_cast<double>(adjustedLive) / adjustedTotal;
-    }
-    
+    m_liveProbability = BatchKernels::evaluate(shell).liveProbability;
     emit probabilityChanged(m_liveProbability);
 }
 
@@ -228,10 +215,12 @@ void ItemManager::addDealerItem(ItemType type)
 
 void ItemManager::usePlayerItem(ItemType type)
 {
-    for (auto &item : m_playerItems) {
+    for (int i = 0; i < m_playerItems.size(); ++i) {
+        auto &item = m_playerItems[i];
         if (item.type == type && !item.isUsed) {
             item.isUsed = true;
             emit itemUsed(true, type);
+            emit itemChanged(true, i);
             break;
         }
     }
@@ -239,10 +228,12 @@ void ItemManager::usePlayerItem(ItemType type)
 
 void ItemManager::useDealerItem(ItemType type)
 {
-    for (auto &item : m_dealerItems) {
+    for (int i = 0; i < m_dealerItems.size(); ++i) {
+        auto &item = m_dealerItems[i];
         if (item.type == type && !item.isUsed) {
             item.isUsed = true;
             emit itemUsed(false, type);
+            emit itemChanged(false, i);
             break;
         }
     }
@@ -252,12 +243,14 @@ void ItemManager::clearAllItems()
 {
     m_playerItems.clear();
     m_dealerItems.clear();
+    emit itemsCleared();
 }
 
 void ItemManager::removePlayerItem(int index)
 {
     if (index >= 0 && index < m_playerItems.size()) {
         m_playerItems.removeAt(index);
+        emit itemRemoved(true, index);
     }
 }
 
@@ -265,6 +258,7 @@ void ItemManager::removeDealerItem(int index)
 {
     if (index >= 0 && index < m_dealerItems.size()) {
         m_dealerItems.removeAt(index);
+        emit itemRemoved(false, index);
     }
 }
 
@@ -317,17 +311,105 @@ QString ItemManager::getItemDescription(ItemType type)
 // DecisionHelper实现
 DecisionHelper::DecisionHelper(QObject *parent)
     : QObject(parent)
-    , m_aiClient(new AIClient(this))
+    , m_networkThread(new QThread(this))
+    , m_scheduler(new AIScheduler)
+    , m_foregroundRequest(0)
+    , m_streaming(false)
+    , m_maxRetries(3)
+    , m_cacheEnabled(true)
+    , m_compactPrompt(false)
+    , m_requestCompact(false)
+    , m_hybridMode(false)
+    , m_localAnswers(0)
+    , m_gatedToAI(0)
+    , m_toolCallingEnabled(false)
+    , m_toolCalls(0)
+    , m_conversationMode(false)
+    , m_hasLastState(false)
+    , m_speculativeEnabled(false)
+    , m_speculationsIssued(0)
+    , m_speculationsUsed(0)
+    , m_speculationsCancelled(0)
 {
-    // 连接AI客户端信号
-    connect(m_aiClient, &AIClient::responseReceived, this, &DecisionHelper::onAIResponse);
-    connect(m_aiClient, &AIClient::errorOccurred, this, &DecisionHelper::onAIError);
-    connect(m_aiClient, &AIClient::requestStarted, this, &DecisionHelper::onAIRequestStarted);
-    connect(m_aiClient, &AIClient::requestFinished, this, &DecisionHelper::onAIRequestFinished);
+    // 网络请求和响应解析在独立线程中进行，界面线程只接收文本结果
+    m_networkThread->setObjectName("AINetworkThread");
+    m_scheduler->moveToThread(m_networkThread);
+    connect(m_networkThread, &QThread::finished, m_scheduler, &QObject::deleteLater);
+    m_networkThread->start();
+    
+    // 调度器按句柄返回结果：前台请求的信号转给界面，其余属于推测预取分支
+    using RequestId = AIScheduler::RequestId;
+    connect(m_scheduler, &AIScheduler::responseReceived, this, [this](RequestId id, const QString &response) {
+        if (id == m_foregroundRequest) {
+            onAIResponse(response);
+        } else {
+            finishSpeculativeBranch(id, response, QString());
+        }
+    });
+    connect(m_scheduler, &AIScheduler::errorOccurred, this, [this](RequestId id, const QString &error) {
+        if (id == m_foregroundRequest) {
+            onAIError(error);
+        } else {
+            finishSpeculativeBranch(id, QString(), error);
+        }
+    });
+    connect(m_scheduler, &AIScheduler::requestStarted, this, [this](RequestId id) {
+        if (id == m_foregroundRequest) {
+            onAIRequestStarted();
+        }
+    });
+    connect(m_scheduler, &AIScheduler::requestFinished, this, [this](RequestId id) {
+        if (id == m_foregroundRequest) {
+            m_foregroundRequest = 0;
+            onAIRequestFinished();
+        }
+    });
+    connect(m_scheduler, &AIScheduler::partialResponse, this, [this](RequestId id, const QString &delta) {
+        if (id == m_foregroundRequest) {
+            emit aiAdviceDelta(delta);
+        }
+    });
+    connect(m_scheduler, &AIScheduler::partialReasoning, this, [this](RequestId id, const QString &delta) {
+        if (id == m_foregroundRequest) {
+            emit aiReasoningDelta(delta);
+        }
+    });
+    connect(m_scheduler, &AIScheduler::connectionInfo, this, [this](RequestId id, bool reused, bool http2) {
+        if (id == m_foregroundRequest) {
+            emit aiConnectionInfo(reused, http2);
+        }
+    });
+    connect(m_scheduler, &AIScheduler::attemptFinished, this,
+            [this](RequestId id, int attempt, int httpStatus, qint64 elapsedMs, int retryDelayMs) {
+        if (id == m_foregroundRequest) {
+            emit aiAttemptFinished(attempt, httpStatus, elapsedMs, retryDelayMs);
+        }
+    });
+    connect(m_scheduler, &AIScheduler::requestThrottled, this, [this](RequestId id, int waitMs) {
+        if (id == m_foregroundRequest) {
+            emit aiRequestThrottled(waitMs);
+        }
+    });
+    connect(m_scheduler, &AIScheduler::usageReported, this, [this](RequestId id, int prompt, int cached, int completion) {
+        if (id == m_foregroundRequest) {
+            onAIUsage(prompt, cached, completion);
+        }
+    });
+    connect(m_scheduler, &AIScheduler::toolCalled, this, [this](RequestId id, const QString &name, const QJsonObject &arguments) {
+        if (id == m_foregroundRequest) {
+            onToolCalled(name, arguments);
+        }
+    });
+    connect(m_scheduler, &AIScheduler::requestMetrics, this, [this](RequestId, const RequestMetrics &metrics) {
+        m_metrics.add(metrics);
+        emit aiMetricsUpdated();
+    });
 }
 
 QString DecisionHelper::getAdvice(const GameState &state)
 {
+    TRACE_SCOPE("DecisionHelper::getAdvice");
+    
     QString advice;
     
     advice += "=== 当前局势分析 ===\n\n";
@@ -343,49 +425,342 @@ QString DecisionHelper::getAdvice(const GameState &state)
 }
 
 double DecisionHelper::calculateExpectedValue(const GameState &state, bool shootDealer)
+{
+    const ShotOdds odds = evaluateShot(state);
+    return shootDealer ? odds.shot.shootOpponentValue : odds.shot.shootSelfValue;
+}
+
+DecisionHelper::ShotOdds DecisionHelper::evaluateShot(const GameState &state)
+{
+    ShotOdds odds{false, false, {}};
+    BatchKernels::Shell shell{static_cast<double>(state.remainingLive), static_cast<double>(state.remainingBlank)};
+    for (const auto &known : state.knownBullets) {
+        if (known.isFired || known.position < state.currentPosition) {
+            continue;
+        }
+        if (known.position == state.currentPosition) {
+            odds.currentKnown = true;
+            odds.currentIsLive = known.isLive;
+            shell.current = known.isLive ? 1.0 : 0.0;
+        } else if (known.isLive) {
+            shell.knownLiveAhead = qMin(shell.knownLiveAhead + 1, shell.live);
+        } else {
+            shell.knownBlankAhead = qMin(shell.knownBlankAhead + 1, shell.blank);
+        }
+    }
+    shell.opponentHealth = state.dealerHealth;
+    shell.ownHealth = state.playerHealth;
+    shell.damage = state.handsawActive ? 2.0 : 1.0;
+    odds.shot = BatchKernels::evaluate(shell);
+    return odds;
+}
+
+double DecisionHelper::calculateWinProbability(const GameState &state, bool shootDealer)
+{
+    // 子博弈不含已知子弹和道具
+    if (!ShotTable::contains(state.remainingLive, state.remainingBlank, state.playerHealth, state.dealerHealth)) {
+        return -1.0;
+    }
+    for (const auto &known : state.knownBullets) {
+        if (!known.isFired && known.position >= state.currentPosition) {
+            return -1.0;
+        }
+    }
+    for (const auto *items : {&state.playerItems, &state.dealerItems}) {
+        for (const auto &item : *items) {
+            if (!item.isUsed) {
+                return -1.0;
+            }
+        }
+    }
+    
+    return ShotTable::playerWinProbability(state.remainingLive, state.remainingBlank, state.playerHealth, state.dealerHealth,
+                                           state.isPlayerTurn, state.handsawActive,
+                                           shootDealer == state.isPlayerTurn ? Action::ShootOpponent : Action::ShootSelf);
+}
+
+double DecisionHelper::expectedValueFor(double liveProbability, bool handsawActive, bool shootDealer)
+{
+    // 与策略竞技场共用同一公式
+    return Policies::expectedValue(liveProbability, handsawActive, shootDealer);
+}
+
+double DecisionHelper::liveProbabilityAt(const GameState &state, int position)
 {
     int totalRemaining = state.remainingLive + state.remainingBlank;
-    if (totalRemaining <= 0) return 0.0;
+    if (position < state.currentPosition || position >= state.currentPosition + totalRemaining) {
+        return -1.0;
+    }
     
-    double liveProbability = static_cast<double>(state.remainingLive) / totalRemaining;
+    // 已知子弹直接确定；其余位置平分未知的实弹
+    int knownLive = 0;
+    int knownBlank = 0;
+    for (const auto &known : state.knownBullets) {
+        if (known.isFired || known.position < state.currentPosition) {
+            continue;
+        }
+        if (known.position == position) {
+            return known.isLive ? 1.0 : 0.0;
+        }
+        if (known.isLive) {
+            ++knownLive;
+        } else {
+            ++knownBlank;
+        }
+    }
+    int unknownSlots = totalRemaining - knownLive - knownBlank;
+    return unknownSlots > 0 ? qBound(0.0, static_cast<double>(state.remainingLive - knownLive) / unknownSlots, 1.0) : 0.0;
+}
+
+namespace {
+bool toModelItem(ItemManager::ItemType type, Item &item)
+{
+    switch (type) {
+    case ItemManager::ItemType::MagnifyingGlass: item = Item::MagnifyingGlass; return true;
+    case ItemManager::ItemType::Cigarettes: item = Item::Cigarettes; return true;
+    case ItemManager::ItemType::Beer: item = Item::Beer; return true;
+    case ItemManager::ItemType::Handsaw: item = Item::Handsaw; return true;
+    case ItemManager::ItemType::Handcuffs: item = Item::Handcuffs; return true;
+    case ItemManager::ItemType::BurnerPhone: item = Item::BurnerPhone; return true;
+    case ItemManager::ItemType::Inverter: item = Item::Inverter; return true;
+    case ItemManager::ItemType::ExpiredMedicine: item = Item::ExpiredMedicine; return true;
+    default: return false;
+    }
+}
+
+ItemManager::ItemType toItemType(Item item)
+{
+    switch (item) {
+    case Item::MagnifyingGlass: return ItemManager::ItemType::MagnifyingGlass;
+    case Item::Cigarettes: return ItemManager::ItemType::Cigarettes;
+    case Item::Beer: return ItemManager::ItemType::Beer;
+    case Item::Handsaw: return ItemManager::ItemType::Handsaw;
+    case Item::Handcuffs: return ItemManager::ItemType::Handcuffs;
+    case Item::BurnerPhone: return ItemManager::ItemType::BurnerPhone;
+    case Item::Inverter: return ItemManager::ItemType::Inverter;
+    default: return ItemManager::ItemType::ExpiredMedicine;
+    }
+}
+}
+
+bool DecisionHelper::toPosition(const GameState &state, Position &position)
+{
+    int totalRemaining = state.remainingLive + state.remainingBlank;
+    int maxHealth = qMax(state.playerMaxHealth, state.dealerMaxHealth);
+    if (totalRemaining <= 0 || totalRemaining > Position::MAX_SHELLS || maxHealth > Position::MAX_HEALTH
+        || state.playerHealth <= 0 || state.dealerHealth <= 0) {
+        return false;
+    }
     
-    // 检查当前位置是否已知
+    position = Position();
+    position.live = static_cast<uint8_t>(state.remainingLive);
+    position.blank = static_cast<uint8_t>(state.remainingBlank);
     for (const auto &known : state.knownBullets) {
-        if (known.position == state.currentPosition && !known.isFired) {
-            liveProbability = known.isLive ? 1.0 : 0.0;
-            break;
+        int offset = known.position - state.currentPosition;
+        if (known.isFired || offset < 0 || offset >= totalRemaining) {
+            continue;
         }
+        position.knownMask |= 1 << offset;
+        position.liveMask |= (known.isLive ? 1 : 0) << offset;
+    }
+    if (position.unknownLive() < 0 || position.unknownLive() > position.unknownSlots()) {
+        return false; // 已知子弹与剩余数量矛盾
     }
     
-    if (shootDealer) {
-        // 射击庄家的期望值
-        double damageMultiplier = state.handsawActive ? 2.0 : 1.0;
-        return liveProbability * damageMultiplier - (1.0 - liveProbability) * 0.1; // 空包弹有小惩罚
-    } else {
-        // 射击自己的期望值
-        return (1.0 - liveProbability) * 1.0 - liveProbability * 2.0; // 实弹惩罚更大
+    const int player = state.isPlayerTurn ? 0 : 1;
+    position.health[player] = static_cast<uint8_t>(state.playerHealth);
+    position.health[1 - player] = static_cast<uint8_t>(state.dealerHealth);
+    position.maxHealth = static_cast<uint8_t>(maxHealth);
+    position.sawActive = state.handsawActive;
+    
+    const QList<ItemManager::ItemInfo> *sides[2] = {&state.playerItems, &state.dealerItems};
+    for (int side = 0; side < 2; ++side) {
+        for (const auto &info : *sides[side]) {
+            if (info.isUsed) {
+                continue;
+            }
+            Item item;
+            if (!toModelItem(info.type, item)) {
+                return false;
+            }
+            uint8_t &count = position.items[side == 0 ? player : 1 - player][static_cast<int>(item)];
+            count = qMin<uint8_t>(count + 1, Position::MAX_ITEM_COUNT);
+        }
     }
+    return true;
 }
 
-QString DecisionHelper::analyzeCurrentSituation(const GameState &state)
+QString DecisionHelper::describeAction(Action action)
+{
+    if (action == Action::ShootOpponent) {
+        return "射击对手";
+    }
+    if (action == Action::ShootSelf) {
+        return "射击自己";
+    }
+    return "使用" + ItemManager::getItemName(toItemType(itemOf(action)));
+}
+
+std::optional<PolicyTable::Answer> DecisionHelper::probeSolved(const GameState &state)
+{
+    Position position;
+    if (!state.isPlayerTurn || !toPosition(state, position)) {
+        return std::nullopt;
+    }
+    return PolicyTable::probe(position);
+}
+
+std::optional<ParallelSolver::Result> DecisionHelper::searchPosition(const GameState &state)
+{
+    Position position;
+    if (!state.isPlayerTurn || !toPosition(state, position)
+        || ParallelSolver::remainingWork(position) > LOCAL_SEARCH_MAX_WORK) {
+        return std::nullopt;
+    }
+    return ParallelSolver::shared().solve(position);
+}
+
+DecisionHelper::LocalVerdict DecisionHelper::evaluateLocally(const GameState &state)
 {
-    QString analysis;
-    
     int totalRemaining = state.remainingLive + state.remainingBlank;
-    double liveProbability = totalRemaining > 0 ? 
-        static_cast<double>(state.remainingLive) / totalRemaining : 0.0;
+    if (totalRemaining <= 0) {
+        return {false, QString(), "当前没有进行中的回合"};
+    }
+    
+    bool hasHandsaw = false;
+    bool hasCigarettes = false;
+    bool hasInverter = false;
+    QStringList unmodeledItems;
+    for (const auto &item : state.playerItems) {
+        if (item.isUsed) {
+            continue;
+        }
+        if (item.type == ItemManager::ItemType::Handsaw) {
+            hasHandsaw = true;
+        } else if (item.type == ItemManager::ItemType::Cigarettes) {
+            hasCigarettes = true;
+        } else {
+            hasInverter = hasInverter || item.type == ItemManager::ItemType::Inverter;
+            if (!unmodeledItems.contains(item.name)) {
+                unmodeledItems.append(item.name);
+            }
+        }
+    }
     
-    // 检查当前位置是否已知
     bool currentKnown = false;
     bool currentIsLive = false;
     for (const auto &known : state.knownBullets) {
         if (known.position == state.currentPosition && !known.isFired) {
             currentKnown = true;
             currentIsLive = known.isLive;
-            liveProbability = currentIsLive ? 1.0 : 0.0;
             break;
         }
     }
+    if (!currentKnown && (state.remainingLive == 0 || state.remainingBlank == 0)) {
+        currentKnown = true;
+        currentIsLive = state.remainingLive > 0;
+    }
+    
+    QString healHint;
+    if (hasCigarettes && state.playerHealth < state.playerMaxHealth) {
+        healHint = "\n可先使用香烟回复1点血量";
+    }
+    
+    // 当前子弹确定：行动显然，道具只影响附加建议
+    if (currentKnown) {
+        QString reason = state.remainingLive == 0 || state.remainingBlank == 0
+            ? QString("剩余子弹全部为%1").arg(currentIsLive ? "实弹" : "空包弹")
+            : QString("当前子弹已知为%1").arg(currentIsLive ? "实弹" : "空包弹");
+        if (currentIsLive) {
+            QString advice = "推荐：射击庄家";
+            if (state.handsawActive) {
+                advice += "（手锯已激活，造成双倍伤害）";
+            } else if (hasHandsaw && state.dealerHealth > 1) {
+                advice += "，射击前先使用手锯造成双倍伤害";
+            }
+            return {true, advice + healHint, reason};
+        }
+        QString advice = totalRemaining == 1 ? "推荐：射击自己（最后一发空包弹，本回合随之结束）"
+                                             : "推荐：射击自己（空包弹，保留行动回合）";
+        if (hasInverter) {
+            advice += "\n也可使用逆变器将其变为实弹后射击庄家";
+        }
+        return {true, advice + healHint, reason};
+    }
+    
+    // 常见局面查内嵌的已解局面表，道具组合也已计入
+    if (const auto solved = probeSolved(state)) {
+        return {true, QString("推荐：%1").arg(describeAction(solved->best)),
+                QString("已解局面表：最优行动胜率 %1%").arg(solved->value * 100, 0, 'f', 1)};
+    }
+    
+    // 其余可建模的局面由搜索给出精确胜率
+    if (const auto searched = searchPosition(state)) {
+        if (searched->value - searched->runnerUp < LOCAL_WIN_RATE_MARGIN) {
+            return {false, QString(), QString("最优两种行动胜率接近（%1% 与 %2%）")
+                                          .arg(searched->value * 100, 0, 'f', 1).arg(searched->runnerUp * 100, 0, 'f', 1)};
+        }
+        return {true, QString("推荐：%1").arg(describeAction(searched->best)),
+                QString("本地搜索：最优行动胜率 %1%，次优 %2%")
+                    .arg(searched->value * 100, 0, 'f', 1).arg(searched->runnerUp * 100, 0, 'f', 1)};
+    }
+    
+    // 当前子弹未知：持有本地模型未覆盖的道具时，最佳行动取决于道具组合
+    if (!unmodeledItems.isEmpty()) {
+        return {false, QString(), QString("持有%1，超出本地引擎模型").arg(unmodeledItems.join("、"))};
+    }
+    
+    // 无道具时按子博弈的精确胜率判断
+    double shootDealerWin = calculateWinProbability(state, true);
+    double shootSelfWin = calculateWinProbability(state, false);
+    if (shootDealerWin >= 0.0 && shootSelfWin >= 0.0) {
+        if (qAbs(shootDealerWin - shootSelfWin) < LOCAL_WIN_RATE_MARGIN) {
+            return {false, QString(), QString("两种行动胜率接近（射击庄家 %1%，射击自己 %2%）")
+                                          .arg(shootDealerWin * 100, 0, 'f', 1).arg(shootSelfWin * 100, 0, 'f', 1)};
+        }
+        QString reason = QString("无道具子博弈：射击庄家胜率 %1%，射击自己胜率 %2%")
+            .arg(shootDealerWin * 100, 0, 'f', 1).arg(shootSelfWin * 100, 0, 'f', 1);
+        return {true, shootDealerWin > shootSelfWin ? "推荐：射击庄家" : "推荐：射击自己", reason};
+    }
+    
+    const ShotOdds odds = evaluateShot(state);
+    double shootDealerEV = odds.shot.shootOpponentValue;
+    double shootSelfEV = odds.shot.shootSelfValue;
+    if (qAbs(shootDealerEV - shootSelfEV) < LOCAL_DECISION_MARGIN) {
+        return {false, QString(), QString("两种行动期望值接近（射击庄家 %1，射击自己 %2）")
+                                      .arg(shootDealerEV, 0, 'f', 2).arg(shootSelfEV, 0, 'f', 2)};
+    }
+    
+    QString reason = QString("实弹概率 %1%，射击庄家期望值 %2，射击自己期望值 %3")
+        .arg(odds.shot.liveProbability * 100, 0, 'f', 1).arg(shootDealerEV, 0, 'f', 2).arg(shootSelfEV, 0, 'f', 2);
+    QString advice = shootDealerEV > shootSelfEV ? "推荐：射击庄家" : "推荐：射击自己";
+    return {true, advice + healHint, reason};
+}
+
+QString DecisionHelper::gatingSummary() const
+{
+    // 以实测的平均AI请求耗时估算节省的等待时间
+    qint64 latencyMs = 0;
+    int requests = 0;
+    for (const PromptStats &stats : m_promptStats) {
+        latencyMs += stats.latencyMs;
+        requests += stats.requests;
+    }
+    QString summary = QString("本地引擎：直接作答 %1 次，转交AI %2 次").arg(m_localAnswers).arg(m_gatedToAI);
+    if (requests > 0 && m_localAnswers > 0) {
+        summary += QString("，约节省 %1 秒").arg(m_localAnswers * latencyMs / 1000.0 / requests, 0, 'f', 1);
+    }
+    return summary;
+}
+
+QString DecisionHelper::analyzeCurrentSituation(const GameState &state)
+{
+    QString analysis;
+    
+    const ShotOdds odds = evaluateShot(state);
+    const bool currentKnown = odds.currentKnown;
+    const bool currentIsLive = odds.currentIsLive;
+    const double liveProbability = odds.shot.liveProbability;
     
     analysis += QString("剩余子弹：%1发实弹，%2发空包弹\n")
         .arg(state.remainingLive).arg(state.remainingBlank);
@@ -418,22 +793,13 @@ QString DecisionHelper::recommendAction(const GameState &state)
         return "回合结束，等待新回合开始。";
     }
     
-    double liveProbability = static_cast<double>(state.remainingLive) / totalRemaining;
-    
-    // 检查当前位置是否已知
-    bool currentKnown = false;
-    bool currentIsLive = false;
-    for (const auto &known : state.knownBullets) {
-        if (known.position == state.currentPosition && !known.isFired) {
-            currentKnown = true;
-            currentIsLive = known.isLive;
-            liveProbability = currentIsLive ? 1.0 : 0.0;
-            break;
-        }
-    }
-    
-    double shootDealerEV = calculateExpectedValue(state, true);
-    double shootSelfEV = calculateExpectedValue(state, false);
+    // 概率和两种射击的期望值只计算一次
+    const ShotOdds odds = evaluateShot(state);
+    const bool currentKnown = odds.currentKnown;
+    const bool currentIsLive = odds.currentIsLive;
+    const double liveProbability = odds.shot.liveProbability;
+    const double shootDealerEV = odds.shot.shootOpponentValue;
+    const double shootSelfEV = odds.shot.shootSelfValue;
     
     if (currentKnown) {
         if (currentIsLive) {
@@ -445,14 +811,23 @@ QString DecisionHelper::recommendAction(const GameState &state)
         } else {
             recommendation += "推荐：射击自己（已知空包弹，可以连续行动）\n";
         }
+    } else if (const auto solved = probeSolved(state)) {
+        recommendation += QString("推荐：%1（已解局面表，胜率 %2%）\n")
+            .arg(describeAction(solved->best)).arg(solved->value * 100, 0, 'f', 1);
     } else {
-        if (liveProbability >= 0.7) {
+        if (liveProbability >= Policies::HIGH_LIVE_PROBABILITY) {
             recommendation += "推荐：射击庄家（高实弹概率）\n";
             if (state.handsawActive) {
                 recommendation += "手锯激活，伤害翻倍，强烈推荐射击庄家！\n";
             }
-        } else if (liveProbability <= 0.3) {
+        } else if (liveProbability <= Policies::LOW_LIVE_PROBABILITY) {
             recommendation += "推荐：射击自己（低实弹概率，有机会连续行动）\n";
+        } else if (double shootDealerWin = calculateWinProbability(state, true); shootDealerWin >= 0.0) {
+            double shootSelfWin = calculateWinProbability(state, false);
+            recommendation += "中等概率，按无道具子博弈的精确胜率决定：\n";
+            recommendation += QString("- 射击庄家胜率：%1%\n").arg(shootDealerWin * 100, 0, 'f', 1);
+            recommendation += QString("- 射击自己胜率：%1%\n").arg(shootSelfWin * 100, 0, 'f', 1);
+            recommendation += shootDealerWin > shootSelfWin ? "推荐：射击庄家\n" : "推荐：射击自己\n";
         } else {
             recommendation += "中等概率，建议根据当前局势和道具情况决定：\n";
             recommendation += QString("- 射击庄家期望值：%1\n").arg(shootDealerEV);
@@ -560,74 +935,330 @@ QString DecisionHelper::analyzeItems(const GameState &state)
 // AI相关方法实现
 void DecisionHelper::getAIAdvice(const GameState &state, const QString &apiUrl, const QString &apiKey, const QString &model, const QString &customPrompt)
 {
-    qDebug() << "=== DecisionHelper AI Request ===";
-    qDebug() << "Game State:";
-    qDebug() << "  Remaining Live:" << state.remainingLive;
-    qDebug() << "  Remaining Blank:" << state.remainingBlank;
-    qDebug() << "  Current Position:" << state.currentPosition;
-    qDebug() << "  Player Health:" << state.playerHealth;
-    qDebug() << "  Dealer Health:" << state.dealerHealth;
-    qDebug() << "  Is Player Turn:" << state.isPlayerTurn;
-    qDebug() << "  Handsaw Active:" << state.handsawActive;
-    qDebug() << "  Known Bullets Count:" << state.knownBullets.size();
-    qDebug() << "  Player Items Count:" << state.playerItems.size();
-    qDebug() << "  Dealer Items Count:" << state.dealerItems.size();
+    TRACE_SCOPE("DecisionHelper::getAIAdvice");
+    
+    logDebug(lcDecision) << "=== DecisionHelper AI Request ===";
+    logDebug(lcDecision) << "Game State:";
+    logDebug(lcDecision) << "  Remaining Live:" << state.remainingLive;
+    logDebug(lcDecision) << "  Remaining Blank:" << state.remainingBlank;
+    logDebug(lcDecision) << "  Current Position:" << state.currentPosition;
+    logDebug(lcDecision) << "  Player Health:" << state.playerHealth;
+    logDebug(lcDecision) << "  Dealer Health:" << state.dealerHealth;
+    logDebug(lcDecision) << "  Is Player Turn:" << state.isPlayerTurn;
+    logDebug(lcDecision) << "  Handsaw Active:" << state.handsawActive;
+    logDebug(lcDecision) << "  Known Bullets Count:" << state.knownBullets.size();
+    logDebug(lcDecision) << "  Player Items Count:" << state.playerItems.size();
+    logDebug(lcDecision) << "  Dealer Items Count:" << state.dealerItems.size();
     
     // 详细打印已知子弹信息
     for (int i = 0; i < state.knownBullets.size(); ++i) {
         const auto &bullet = state.knownBullets[i];
-        qDebug() << QString("  Known Bullet %1: Position=%2, IsLive=%3, IsFired=%4")
+        logTrace(lcDecision) << QString("  Known Bullet %1: Position=%2, IsLive=%3, IsFired=%4")
                     .arg(i).arg(bullet.position).arg(bullet.isLive).arg(bullet.isFired);
     }
     
     // 详细打印道具信息
-    qDebug() << "  Player Items:";
+    logDebug(lcDecision) << "  Player Items:";
     for (int i = 0; i < state.playerItems.size(); ++i) {
         const auto &item = state.playerItems[i];
-        qDebug() << QString("    Item %1: %2 (Used: %3)").arg(i).arg(item.name).arg(item.isUsed);
+        logTrace(lcDecision) << QString("    Item %1: %2 (Used: %3)").arg(i).arg(item.name).arg(item.isUsed);
     }
     
-    qDebug() << "  Dealer Items:";
+    logDebug(lcDecision) << "  Dealer Items:";
     for (int i = 0; i < state.dealerItems.size(); ++i) {
         const auto &item = state.dealerItems[i];
-        qDebug() << QString("    Item %1: %2 (Used: %3)").arg(i).arg(item.name).arg(item.isUsed);
+        logTrace(lcDecision) << QString("    Item %1: %2 (Used: %3)").arg(i).arg(item.name).arg(item.isUsed);
+    }
+    
+    logDebug(lcDecision) << "API Configuration:";
+    logDebug(lcDecision) << "  API URL:" << apiUrl;
+    logDebug(lcDecision) << "  API Key Length:" << apiKey.length();
+    logDebug(lcDecision) << "  Model:" << (model.isEmpty() ? "gpt-3.5-turbo (default)" : model);
+    logDebug(lcDecision) << "  Custom Prompt Length:" << customPrompt.length();
+    
+    m_lastState = state;
+    m_hasLastState = true;
+    m_apiUrl = apiUrl;
+    m_apiKey = apiKey;
+    m_model = model;
+    m_customPrompt = customPrompt;
+    
+    m_pendingCacheKey.clear();
+    m_attachedSpeculationKey.clear();
+    
+    // 混合模式：本地引擎能明确判断时立即作答，不请求AI
+    if (m_hybridMode) {
+        LocalVerdict verdict = evaluateLocally(state);
+        if (verdict.decisive) {
+            ++m_localAnswers;
+            logDebug(lcDecision) << "Local engine answered:" << verdict.reason;
+            emit aiGatingInfo(gatingSummary());
+            cancelForegroundRequest();
+            emit aiRequestStarted();
+            emit aiAdviceReceived(QString("🧮 [本地引擎]\n\n%1\n依据：%2（局面明确，未请求AI）")
+                                      .arg(verdict.advice, verdict.reason));
+            emit aiRequestFinished();
+            return;
+        }
+        ++m_gatedToAI;
+        logDebug(lcDecision) << "Local engine deferred to AI:" << verdict.reason;
+        emit aiGatingInfo(gatingSummary() + "\n转交AI：" + verdict.reason);
     }
     
-    qDebug() << "API Configuration:";
-    qDebug() << "  API URL:" << apiUrl;
-    qDebug() << "  API Key Length:" << apiKey.length();
-    qDebug() << "  Model:" << (model.isEmpty() ? "gpt-3.5-turbo (default)" : model);
-    qDebug() << "  Custom Prompt Length:" << customPrompt.length();
+    QByteArray cacheKey = AdviceCache::makeKey(canonicalState(state, model, customPrompt));
     
-    m_aiClient->setApiUrl(apiUrl);
-    m_aiClient->setApiKey(apiKey);
-    m_aiClient->setModel(model);  // 设置AI模型
+    // 预取命中：结果已就绪，直接返回
+    if (m_prefetchedAdvice.contains(cacheKey)) {
+        ++m_speculationsUsed;
+        emit aiSpeculationInfo(speculationSummary());
+        cancelForegroundRequest();
+        emit aiRequestStarted();
+        emit aiAdviceReceived("⚡ [预取结果]\n\n" + m_prefetchedAdvice.take(cacheKey).advice);
+        emit aiRequestFinished();
+        prefetchSuccessors(state);
+        return;
+    }
+    
+    // 预取仍在进行：等待该分支完成，不重复发送
+    for (const auto &branch : m_speculations) {
+        if (branch.cacheKey == cacheKey) {
+            logDebug(lcDecision) << "Attaching to in-flight speculative request";
+            cancelForegroundRequest();
+            m_attachedSpeculationKey = cacheKey;
+            emit aiRequestStarted();
+            return;
+        }
+    }
+    
+    // 相同局面直接返回缓存的建议
+    if (m_cacheEnabled) {
+        QString cachedAdvice;
+        bool hit = m_adviceCache.lookup(cacheKey, &cachedAdvice);
+        logDebug(lcDecision) << "Advice cache" << (hit ? "hit" : "miss") << cacheKey.left(12)
+                             << "hit rate:" << m_adviceCache.stats().hitRate();
+        emit aiCacheInfo(hit, m_adviceCache.stats());
+        if (hit) {
+            cancelForegroundRequest();
+            emit aiRequestStarted();
+            emit aiAdviceReceived("⚡ [缓存结果]\n\n" + cachedAdvice);
+            emit aiRequestFinished();
+            prefetchSuccessors(state);
+            return;
+        }
+        m_pendingCacheKey = cacheKey;
+    }
     
     QString systemPrompt = buildSystemPrompt();
     QString userPrompt = buildUserPrompt(state, customPrompt);
     
-    qDebug() << "Prompt Lengths:";
-    qDebug() << "  System Prompt:" << systemPrompt.length() << "chars";
-    qDebug() << "  User Prompt:" << userPrompt.length() << "chars";
+    // 多轮对话：同一大回合内只发送局面变化，历史对话随请求一起发送
+    ConversationTurn turn;
+    if (m_conversationMode) {
+        turn = prepareConversationTurn(state, model, customPrompt);
+        userPrompt = turn.userPrompt;
+    }
+    
+    logDebug(lcDecision) << "Prompt Lengths:";
+    logDebug(lcDecision) << "  System Prompt:" << systemPrompt.length() << "chars";
+    logDebug(lcDecision) << "  User Prompt:" << userPrompt.length() << "chars";
+    
+    // 发送前给出token估算，紧凑模式同时显示相对完整提示词的节省比例
+    int estimate = AIClient::estimatePromptTokens(systemPrompt, userPrompt);
+    if (m_compactPrompt) {
+        int verboseEstimate = AIClient::estimatePromptTokens(buildVerboseSystemPrompt(),
+                                                             buildVerboseUserPrompt(state, customPrompt));
+        m_promptEstimate = QString("提示词：紧凑模式，预计输入约 %1 tokens（完整模式约 %2，减少 %3%）")
+            .arg(estimate).arg(verboseEstimate)
+            .arg(verboseEstimate > 0 ? 100 - estimate * 100 / verboseEstimate : 0);
+    } else {
+        m_promptEstimate = QString("提示词：完整模式，预计输入约 %1 tokens").arg(estimate);
+    }
+    if (turn.valid) {
+        int historyTokens = AIClient::estimateHistoryTokens(turn.history);
+        m_promptEstimate += turn.fullState
+            ? QString("\n多轮对话：新会话，发送完整局面")
+            : QString("\n多轮对话：第 %1 次增量，历史约 %2 tokens，合计约 %3 tokens")
+                  .arg(m_conversation.deltaTurns + 1).arg(historyTokens).arg(estimate + historyTokens);
+    }
+    logDebug(lcDecision) << "  Estimated prompt tokens:" << estimate;
+    emit aiPromptInfo(promptSummary());
+    
+    m_requestCompact = m_compactPrompt;
+    m_promptTimer.start();
     
-    m_aiClient->sendRequest(systemPrompt, userPrompt);
+    AIScheduler::Request request;
+    request.endpoint = {apiUrl, apiKey, model};
+    request.systemPrompt = systemPrompt;
+    request.userPrompt = userPrompt;
+    request.history = turn.history;
+    request.priority = AIScheduler::Interactive;
+    request.streaming = m_streaming;
+    request.maxRetries = m_maxRetries;
+    if (m_toolCallingEnabled) {
+        request.tools = buildTools(state);
+    }
+    cancelForegroundRequest();
+    m_pendingTurn = turn;
+    m_foregroundRequest = m_scheduler->submit(request);
+}
+
+DecisionHelper::~DecisionHelper()
+{
+    m_networkThread->quit();
+    m_networkThread->wait();
+}
+
+void DecisionHelper::cancelForegroundRequest()
+{
+    // 取消在网络线程中异步完成；这里立即结束前台状态，之后到达的旧句柄信号都会被忽略
+    if (m_foregroundRequest != 0) {
+        m_scheduler->cancel(m_foregroundRequest);
+        m_foregroundRequest = 0;
+        m_pendingTurn = ConversationTurn();
+        onAIRequestFinished();
+    }
 }
 
 void DecisionHelper::cancelAIRequest()
 {
-    m_aiClient->cancelRequest();
+    cancelForegroundRequest();
+    if (!m_attachedSpeculationKey.isEmpty()) {
+        m_attachedSpeculationKey.clear();
+        emit aiRequestFinished();
+    }
+}
+
+void DecisionHelper::setStreamingEnabled(bool enabled)
+{
+    m_streaming = enabled;
+}
+
+void DecisionHelper::configureAI(const QString &apiUrl, const QString &apiKey, const QString &model)
+{
+    // 设置加载或保存后立即预热连接，第一次获取建议时无需再握手
+    if (!apiUrl.isEmpty()) {
+        m_scheduler->warmUp({apiUrl, apiKey, model});
+    }
+}
+
+void DecisionHelper::setBackupEndpoints(const QList<AIClient::Endpoint> &endpoints, bool hedgingEnabled, int hedgePercentile)
+{
+    m_scheduler->setBackupEndpoints(endpoints);
+    m_scheduler->setHedging(hedgingEnabled, hedgePercentile);
+}
+
+void DecisionHelper::setRetryPolicy(int maxRetries, int requestsPerMinute)
+{
+    m_maxRetries = qMax(0, maxRetries);
+    m_scheduler->setRequestsPerMinute(requestsPerMinute);
+}
+
+void DecisionHelper::setMaxConcurrentRequests(int maxConcurrent)
+{
+    m_scheduler->setMaxConcurrentPerEndpoint(maxConcurrent);
+}
+
+void DecisionHelper::setCompactPrompt(bool enabled)
+{
+    m_compactPrompt = enabled;
+}
+
+void DecisionHelper::setHybridMode(bool enabled)
+{
+    m_hybridMode = enabled;
+}
+
+void DecisionHelper::setToolCallingEnabled(bool enabled)
+{
+    m_toolCallingEnabled = enabled;
+}
+
+const AIMetrics &DecisionHelper::metrics() const
+{
+    return m_metrics;
+}
+
+void DecisionHelper::clearMetrics()
+{
+    m_metrics.clear();
+    emit aiMetricsUpdated();
+}
+
+void DecisionHelper::setCacheEnabled(bool enabled)
+{
+    m_cacheEnabled = enabled;
+}
+
+void DecisionHelper::clearAdviceCache()
+{
+    m_adviceCache.clear();
 }
 
 void DecisionHelper::onAIResponse(const QString &response)
 {
+    if (m_promptTimer.isValid()) {
+        PromptStats &stats = m_promptStats[m_requestCompact ? 1 : 0];
+        ++stats.requests;
+        stats.latencyMs += m_promptTimer.elapsed();
+        m_promptTimer.invalidate();
+        emit aiPromptInfo(promptSummary());
+    }
+    
+    if (!m_pendingCacheKey.isEmpty()) {
+        m_adviceCache.insert(m_pendingCacheKey, response);
+        m_pendingCacheKey.clear();
+    }
+    commitConversationTurn(response);
     emit aiAdviceReceived(response);
+    
+    // 玩家阅读建议、思考行动时，预取下一发之后的局面
+    if (m_hasLastState) {
+        prefetchSuccessors(m_lastState);
+    }
 }
 
 void DecisionHelper::onAIError(const QString &error)
 {
+    m_pendingCacheKey.clear();
+    m_pendingTurn = ConversationTurn(); // 失败的轮次不进入历史，下次仍从模型已知的局面计算变化
     emit aiError(error);
 }
 
+void DecisionHelper::onAIUsage(int promptTokens, int cachedPromptTokens, int completionTokens)
+{
+    Q_UNUSED(completionTokens);
+    PromptStats &stats = m_promptStats[m_requestCompact ? 1 : 0];
+    ++stats.usageReports;
+    stats.promptTokens += promptTokens;
+    stats.cachedTokens += cachedPromptTokens;
+}
+
+QString DecisionHelper::promptSummary() const
+{
+    // 按模式给出实测平均输入token（含前缀缓存命中）和平均耗时
+    QStringList measured;
+    const char *names[2] = {"完整", "紧凑"};
+    for (int mode = 0; mode < 2; ++mode) {
+        const PromptStats &stats = m_promptStats[mode];
+        if (stats.requests == 0) {
+            continue;
+        }
+        QString entry = QString("%1 %2次").arg(names[mode]).arg(stats.requests);
+        if (stats.usageReports > 0) {
+            entry += QString(" 平均输入 %1 tokens（缓存 %2）")
+                .arg(stats.promptTokens / stats.usageReports)
+                .arg(stats.cachedTokens / stats.usageReports);
+        }
+        entry += QString(" 平均 %1 秒").arg(stats.latencyMs / 1000.0 / stats.requests, 0, 'f', 1);
+        measured.append(entry);
+    }
+    
+    if (measured.isEmpty()) {
+        return m_promptEstimate;
+    }
+    return m_promptEstimate + "\n实测：" + measured.join("；");
+}
+
 void DecisionHelper::onAIRequestStarted()
 {
     emit aiRequestStarted();
@@ -638,7 +1269,423 @@ void DecisionHelper::onAIRequestFinished()
     emit aiRequestFinished();
 }
 
+void DecisionHelper::setSpeculativePrefetch(bool enabled)
+{
+    m_speculativeEnabled = enabled;
+    if (!enabled) {
+        cancelSpeculation();
+    }
+}
+
+void DecisionHelper::resolveSpeculation(int position, bool isLive)
+{
+    // 真实结果已知：只保留基于该发、且假设与结果一致（空包弹）的分支和预取结果，其余全部作废
+    auto survives = [position, isLive](int basePosition) {
+        return !isLive && basePosition == position;
+    };
+    
+    bool attachedDropped = false;
+    for (int i = m_speculations.size() - 1; i >= 0; --i) {
+        if (!survives(m_speculations[i].basePosition)) {
+            SpeculativeBranch branch = m_speculations.takeAt(i);
+            m_scheduler->cancel(branch.request);
+            ++m_speculationsCancelled;
+            if (!m_attachedSpeculationKey.isEmpty() && branch.cacheKey == m_attachedSpeculationKey) {
+                attachedDropped = true;
+            }
+        }
+    }
+    for (auto it = m_prefetchedAdvice.begin(); it != m_prefetchedAdvice.end();) {
+        if (survives(it->basePosition)) {
+            ++it;
+        } else {
+            it = m_prefetchedAdvice.erase(it);
+        }
+    }
+    emit aiSpeculationInfo(speculationSummary());
+    
+    // 前台请求等待的分支被取消：改为正常请求该局面，否则界面会一直停在等待状态
+    if (attachedDropped) {
+        m_attachedSpeculationKey.clear();
+        logDebug(lcDecision) << "Attached speculative branch cancelled, resubmitting as a normal request";
+        const GameState state = m_lastState;
+        getAIAdvice(state, m_apiUrl, m_apiKey, m_model, m_customPrompt);
+    }
+}
+
+void DecisionHelper::cancelSpeculation()
+{
+    const QList<SpeculativeBranch> branches = m_speculations;
+    m_speculations.clear();
+    for (const auto &branch : branches) {
+        m_scheduler->cancel(branch.request);
+        ++m_speculationsCancelled;
+    }
+    m_prefetchedAdvice.clear();
+    
+    if (!m_attachedSpeculationKey.isEmpty()) {
+        m_attachedSpeculationKey.clear();
+        emit aiRequestFinished();
+    }
+}
+
+DecisionHelper::GameState DecisionHelper::successorState(const GameState &state, bool isLive)
+{
+    // 假设血量不变：射击自己的空包弹继续回合；其他情况由用户调整血量后会重新计算
+    GameState next = state;
+    if (isLive) {
+        next.remainingLive = qMax(0, next.remainingLive - 1);
+    } else {
+        next.remainingBlank = qMax(0, next.remainingBlank - 1);
+    }
+    for (auto &bullet : next.knownBullets) {
+        if (bullet.position == state.currentPosition) {
+            bullet.isFired = true;
+        }
+    }
+    next.currentPosition = state.currentPosition + 1;
+    next.handsawActive = false;
+    return next;
+}
+
+void DecisionHelper::prefetchSuccessors(const GameState &state)
+{
+    if (!m_speculativeEnabled || m_apiUrl.isEmpty() || !m_speculations.isEmpty()) {
+        return;
+    }
+    
+    int totalRemaining = state.remainingLive + state.remainingBlank;
+    if (totalRemaining <= 1 || state.remainingBlank == 0) {
+        return; // 下一发后回合结束，或不可能是空包弹
+    }
+    for (const auto &known : state.knownBullets) {
+        if (known.position == state.currentPosition && !known.isFired && known.isLive) {
+            return;
+        }
+    }
+    
+    // 只预取空包弹分支：实弹会改变血量并交出回合，玩家再次询问时的局面无法预先确定
+    startSpeculativeBranch(successorState(state, false), state.currentPosition);
+    emit aiSpeculationInfo(speculationSummary());
+}
+
+void DecisionHelper::startSpeculativeBranch(const GameState &state, int basePosition)
+{
+    QByteArray cacheKey = AdviceCache::makeKey(canonicalState(state, m_model, m_customPrompt));
+    if (m_prefetchedAdvice.contains(cacheKey) || (m_cacheEnabled && m_adviceCache.contains(cacheKey))) {
+        return; // 已有结果
+    }
+    if (m_hybridMode && evaluateLocally(state).decisive) {
+        return; // 本地引擎即可作答，无需预取
+    }
+    
+    AIScheduler::Request request;
+    request.endpoint = {m_apiUrl, m_apiKey, m_model};
+    request.systemPrompt = buildSystemPrompt();
+    request.userPrompt = buildUserPrompt(state, m_customPrompt);
+    request.priority = AIScheduler::Background;
+    request.maxRetries = 0; // 预取失败直接放弃，不占用重试和请求预算
+    request.hedging = false;
+    if (m_toolCallingEnabled) {
+        request.tools = buildTools(state);
+    }
+    
+    m_speculations.append({basePosition, cacheKey, m_scheduler->submit(request)});
+    ++m_speculationsIssued;
+    logDebug(lcDecision) << "Speculative prefetch queued for a blank at position" << basePosition;
+}
+
+void DecisionHelper::finishSpeculativeBranch(AIScheduler::RequestId request, const QString &response, const QString &error)
+{
+    QByteArray cacheKey;
+    int basePosition = 0;
+    for (int i = 0; i < m_speculations.size(); ++i) {
+        if (m_speculations[i].request == request) {
+            cacheKey = m_speculations[i].cacheKey;
+            basePosition = m_speculations[i].basePosition;
+            m_speculations.removeAt(i);
+            break;
+        }
+    }
+    if (cacheKey.isEmpty()) {
+        return; // 分支已被取消
+    }
+    
+    bool attached = !m_attachedSpeculationKey.isEmpty() && m_attachedSpeculationKey == cacheKey;
+    
+    if (!response.isEmpty()) {
+        if (m_cacheEnabled) {
+            m_adviceCache.insert(cacheKey, response);
+        }
+        if (attached) {
+            ++m_speculationsUsed;
+            emit aiAdviceReceived("⚡ [预取结果]\n\n" + response);
+        } else {
+            m_prefetchedAdvice.insert(cacheKey, {basePosition, response});
+        }
+    } else if (attached) {
+        emit aiError(error);
+    }
+    
+    if (attached) {
+        m_attachedSpeculationKey.clear();
+        emit aiRequestFinished();
+        if (!response.isEmpty()) {
+            prefetchSuccessors(m_lastState);
+        }
+    }
+    emit aiSpeculationInfo(speculationSummary());
+}
+
+void DecisionHelper::setConversationMode(bool enabled)
+{
+    m_conversationMode = enabled;
+    if (!enabled) {
+        resetConversation();
+    }
+}
+
+void DecisionHelper::resetConversation()
+{
+    m_conversation = Conversation();
+    m_pendingTurn = ConversationTurn();
+}
+
+DecisionHelper::ConversationTurn DecisionHelper::prepareConversationTurn(const GameState &state, const QString &model,
+                                                                         const QString &customPrompt)
+{
+    const Conversation &conversation = m_conversation;
+    ConversationTurn turn;
+    turn.valid = true;
+    turn.state = state;
+    turn.model = model;
+    turn.customPrompt = customPrompt;
+    turn.compact = m_compactPrompt;
+    
+    bool continuing = conversation.active && conversation.model == model
+                      && conversation.customPrompt == customPrompt && conversation.compact == m_compactPrompt
+                      && isSameRound(conversation.knownState, state);
+    
+    // 历史过长时把此前的建议折叠为摘要，以完整局面开始新会话
+    if (continuing && (conversation.deltaTurns >= MAX_CONVERSATION_DELTAS
+                       || AIClient::estimateHistoryTokens(conversation.history) > MAX_HISTORY_TOKENS)) {
+        turn.earlierAdvice = conversation.earlierAdvice;
+        for (int i = 1; i < conversation.history.size(); i += 2) {
+            QString advice = conversation.history[i].toObject()["content"].toString();
+            turn.earlierAdvice.append(advice.section('\n', 0, 0).left(MAX_SUMMARY_LINE_CHARS));
+        }
+        while (turn.earlierAdvice.size() > MAX_SUMMARY_LINES) {
+            turn.earlierAdvice.removeFirst();
+        }
+        continuing = false;
+        logDebug(lcDecision) << "Conversation history folded into" << turn.earlierAdvice.size() << "summary lines";
+    }
+    
+    if (!continuing) {
+        turn.fullState = true;
+        turn.userPrompt = buildUserPrompt(state, customPrompt);
+        if (!turn.earlierAdvice.isEmpty()) {
+            turn.userPrompt += "\n本回合此前的建议摘要：\n- " + turn.earlierAdvice.join("\n- ");
+        }
+        return turn;
+    }
+    
+    QString delta = describeStateDelta(conversation.knownState, state);
+    turn.history = conversation.history;
+    turn.userPrompt = QString("局面更新：\n%1\n请结合之前的对话，针对更新后的局面给出新的行动建议")
+        .arg(delta.isEmpty() ? "- 局面无变化" : delta);
+    return turn;
+}
+
+void DecisionHelper::commitConversationTurn(const QString &advice)
+{
+    if (!m_pendingTurn.valid) {
+        return;
+    }
+    ConversationTurn turn = m_pendingTurn;
+    m_pendingTurn = ConversationTurn();
+    
+    Conversation &conversation = m_conversation;
+    if (turn.fullState) {
+        conversation.history = QJsonArray();
+        conversation.earlierAdvice = turn.earlierAdvice;
+        conversation.deltaTurns = 0;
+    } else {
+        ++conversation.deltaTurns;
+    }
+    conversation.active = true;
+    conversation.knownState = turn.state;
+    conversation.model = turn.model;
+    conversation.customPrompt = turn.customPrompt;
+    conversation.compact = turn.compact;
+    conversation.history.append(QJsonObject{{"role", "user"}, {"content", turn.userPrompt}});
+    conversation.history.append(QJsonObject{{"role", "assistant"}, {"content", condenseAdvice(advice)}});
+}
+
+bool DecisionHelper::isSameRound(const GameState &before, const GameState &after)
+{
+    // 子弹只会减少、位置只会前进；否则说明换了大回合或用户重新录入了局面
+    return after.remainingLive <= before.remainingLive && after.remainingBlank <= before.remainingBlank
+           && after.currentPosition >= before.currentPosition
+           && after.playerMaxHealth == before.playerMaxHealth && after.dealerMaxHealth == before.dealerMaxHealth;
+}
+
+QString DecisionHelper::describeStateDelta(const GameState &before, const GameState &after)
+{
+    QStringList changes;
+    
+    int liveGone = before.remainingLive - after.remainingLive;
+    int blankGone = before.remainingBlank - after.remainingBlank;
+    if (liveGone > 0) {
+        changes.append(QString("打出或退出实弹 %1 发").arg(liveGone));
+    }
+    if (blankGone > 0) {
+        changes.append(QString("打出或退出空包弹 %1 发").arg(blankGone));
+    }
+    if (after.currentPosition != before.currentPosition) {
+        changes.append(QString("当前为第 %1 发，剩余实弹 %2、空包弹 %3")
+                           .arg(after.currentPosition).arg(after.remainingLive).arg(after.remainingBlank));
+    }
+    
+    if (after.playerHealth != before.playerHealth) {
+        changes.append(QString("玩家血量 %1→%2").arg(before.playerHealth).arg(after.playerHealth));
+    }
+    if (after.dealerHealth != before.dealerHealth) {
+        changes.append(QString("庄家血量 %1→%2").arg(before.dealerHealth).arg(after.dealerHealth));
+    }
+    
+    // 新得知的子弹
+    for (const auto &bullet : after.knownBullets) {
+        if (bullet.isFired) {
+            continue;
+        }
+        bool alreadyKnown = std::any_of(before.knownBullets.begin(), before.knownBullets.end(),
+                                        [&bullet](const BulletTracker::BulletInfo &known) {
+            return known.position == bullet.position && !known.isFired;
+        });
+        if (!alreadyKnown) {
+            changes.append(QString("得知第 %1 发为%2").arg(bullet.position).arg(bullet.isLive ? "实弹" : "空包弹"));
+        }
+    }
+    
+    // 按道具名比较未使用数量，减少为使用或被偷，增加为获得
+    auto diffItems = [&changes](const char *owner, const QList<ItemManager::ItemInfo> &beforeItems,
+                                const QList<ItemManager::ItemInfo> &afterItems) {
+        QMap<QString, int> counts;
+        for (const auto &item : beforeItems) {
+            if (!item.isUsed) {
+                --counts[item.name];
+            }
+        }
+        for (const auto &item : afterItems) {
+            if (!item.isUsed) {
+                ++counts[item.name];
+            }
+        }
+        for (auto it = counts.cbegin(); it != counts.cend(); ++it) {
+            if (it.value() < 0) {
+                changes.append(QString("%1使用或失去 %2×%3").arg(owner, it.key()).arg(-it.value()));
+            } else if (it.value() > 0) {
+                changes.append(QString("%1获得 %2×%3").arg(owner, it.key()).arg(it.value()));
+            }
+        }
+    };
+    diffItems("玩家", before.playerItems, after.playerItems);
+    diffItems("庄家", before.dealerItems, after.dealerItems);
+    
+    if (after.handsawActive != before.handsawActive) {
+        changes.append(after.handsawActive ? "手锯已激活（下一发双倍伤害）" : "手锯效果已结束");
+    }
+    if (after.isPlayerTurn != before.isPlayerTurn) {
+        changes.append(after.isPlayerTurn ? "轮到玩家" : "轮到庄家");
+    }
+    
+    if (changes.isEmpty()) {
+        return QString();
+    }
+    return "- " + changes.join("\n- ");
+}
+
+QString DecisionHelper::condenseAdvice(const QString &advice)
+{
+    // 历史中只保留正式回答，思考过程不再发送
+    QString answer = advice;
+    int answerStart = answer.indexOf("正式回答：\n");
+    if (answerStart >= 0) {
+        answer = answer.mid(answerStart + QString("正式回答：\n").length());
+    }
+    answer = answer.trimmed();
+    if (answer.length() > MAX_HISTORY_ADVICE_CHARS) {
+        answer = answer.left(MAX_HISTORY_ADVICE_CHARS) + "…";
+    }
+    return answer;
+}
+
+QString DecisionHelper::speculationSummary() const
+{
+    return QString("预取：进行中 %1，已发起 %2，命中 %3，取消 %4")
+        .arg(m_speculations.size()).arg(m_speculationsIssued)
+        .arg(m_speculationsUsed).arg(m_speculationsCancelled);
+}
+
+QByteArray DecisionHelper::canonicalState(const GameState &state, const QString &model, const QString &customPrompt) const
+{
+    QByteArray key = "v1";
+    key += QString("|L%1|B%2|P%3/%4|D%5/%6|T%7|S%8")
+        .arg(state.remainingLive).arg(state.remainingBlank)
+        .arg(state.playerHealth).arg(state.playerMaxHealth)
+        .arg(state.dealerHealth).arg(state.dealerMaxHealth)
+        .arg(state.isPlayerTurn ? 1 : 0).arg(state.handsawActive ? 1 : 0).toUtf8();
+    
+    // 已知子弹按相对当前位置的偏移记录
+    QList<int> knownOffsets;
+    for (const auto &bullet : state.knownBullets) {
+        if (!bullet.isFired && bullet.position >= state.currentPosition) {
+            knownOffsets.append((bullet.position - state.currentPosition) * 2 + (bullet.isLive ? 1 : 0));
+        }
+    }
+    std::sort(knownOffsets.begin(), knownOffsets.end());
+    key += "|K";
+    for (int offset : knownOffsets) {
+        key += QByteArray::number(offset / 2) + (offset % 2 ? 'L' : 'B') + ',';
+    }
+    
+    // 道具与持有顺序无关，只统计未使用的道具种类
+    auto appendItems = [&key](const char *tag, const QList<ItemManager::ItemInfo> &items) {
+        QList<int> types;
+        for (const auto &item : items) {
+            if (!item.isUsed) {
+                types.append(static_cast<int>(item.type));
+            }
+        }
+        std::sort(types.begin(), types.end());
+        key += tag;
+        for (int type : types) {
+            key += QByteArray::number(type) + ',';
+        }
+    };
+    appendItems("|PI", state.playerItems);
+    appendItems("|DI", state.dealerItems);
+    
+    key += "|M" + model.toUtf8();
+    key += "|C" + customPrompt.toUtf8();
+    if (m_compactPrompt) {
+        key += "|F1"; // 紧凑提示词得到的建议单独缓存
+    }
+    return key;
+}
+
 QString DecisionHelper::buildSystemPrompt()
+{
+    return m_compactPrompt ? buildCompactSystemPrompt() : buildVerboseSystemPrompt();
+}
+
+QString DecisionHelper::buildUserPrompt(const GameState &state, const QString &customPrompt)
+{
+    return m_compactPrompt ? buildCompactUserPrompt(state, customPrompt) : buildVerboseUserPrompt(state, customPrompt);
+}
+
+QString DecisionHelper::buildVerboseSystemPrompt()
 {
   return R"(你是一个专业的俄式轮盘赌博游戏Buckshot Roulette博弈分析师，精通概率论和博弈论。
 
@@ -673,7 +1720,7 @@ QString DecisionHelper::buildSystemPrompt()
 )";
 }
 
-QString DecisionHelper::buildUserPrompt(const GameState &state, const QString &customPrompt)
+QString DecisionHelper::buildVerboseUserPrompt(const GameState &state, const QString &customPrompt)
 {
     QString prompt = "当前游戏状态：\n";
 
@@ -738,3 +1785,220 @@ QString DecisionHelper::buildUserPrompt(const GameState &state, const QString &c
     
     return prompt;
 }
+
+QString DecisionHelper::buildCompactSystemPrompt()
+{
+    // 该文本不能包含任何随局面变化的内容：每次请求逐字节相同，服务端才能缓存这段前缀
+    return QStringLiteral(
+        "你是Buckshot Roulette博弈分析师，精通概率论与博弈论。\n"
+        "规则：每大回合2~8发，实弹空包随机排列，玩家先手。打对手：实弹对手扣血，空包换对手回合。"
+        "打自己：空包继续本回合，实弹自己扣血并换回合。子弹打完或有人血量归零则大回合结束，归零者败。"
+        "每大回合发道具（上限8个，不回收），己方回合内可随时使用。\n"
+        "道具：放大镜=看当前弹；香烟=+1血；啤酒=退出当前弹；手锯=下一发实弹伤害×2；手铐=对手跳过下回合；"
+        "一次性电话=随机告知一发的类型；逆变器=当前弹实空互换；肾上腺素=偷对手一个道具（肾上腺素除外）；"
+        "过期药物=50%+2血/50%-1血。\n"
+        "局面格式：L实弹 B空包 P玩家血/上限 D庄家血/上限 N当前第几发；K已知弹(位置:L实/B空)；"
+        "PI玩家道具 DI庄家道具；S=手锯已激活；Q=附加要求。\n"
+        "给出明确行动建议（先用哪些道具、打自己还是打庄家）及关键概率。回复用纯文本，勿用markdown/json。");
+}
+
+QString DecisionHelper::buildCompactUserPrompt(const GameState &state, const QString &customPrompt)
+{
+    QString prompt = QString("L%1 B%2 P%3/%4 D%5/%6 N%7")
+        .arg(state.remainingLive).arg(state.remainingBlank)
+        .arg(state.playerHealth).arg(state.playerMaxHealth)
+        .arg(state.dealerHealth).arg(state.dealerMaxHealth)
+        .arg(state.currentPosition);
+    
+    QStringList known;
+    for (const auto &bullet : state.knownBullets) {
+        if (!bullet.isFired) {
+            known.append(QString("%1:%2").arg(bullet.position).arg(bullet.isLive ? 'L' : 'B'));
+        }
+    }
+    if (!known.isEmpty()) {
+        prompt += "\nK " + known.join(' ');
+    }
+    
+    // 同名道具合并计数，没有道具的一方整行省略
+    auto appendItems = [&prompt](const char *tag, const QList<ItemManager::ItemInfo> &items) {
+        QStringList names;
+        QHash<QString, int> counts;
+        for (const auto &item : items) {
+            if (!item.isUsed && counts[item.name]++ == 0) {
+                names.append(item.name);
+            }
+        }
+        if (names.isEmpty()) {
+            return;
+        }
+        QStringList entries;
+        for (const QString &name : names) {
+            entries.append(counts[name] > 1 ? QString("%1×%2").arg(name).arg(counts[name]) : name);
+        }
+        prompt += QString("\n%1 %2").arg(tag, entries.join(' '));
+    };
+    appendItems("PI", state.playerItems);
+    appendItems("DI", state.dealerItems);
+    
+    if (state.handsawActive) {
+        prompt += "\nS";
+    }
+    if (!customPrompt.isEmpty()) {
+        prompt += "\nQ " + customPrompt;
+    }
+    return prompt;
+}
+
+QJsonObject DecisionHelper::itemOutcome(const GameState &state, ItemManager::ItemType type)
+{
+    const double p = liveProbabilityAt(state, state.currentPosition);
+    const int totalRemaining = state.remainingLive + state.remainingBlank;
+    QJsonObject result{{"item", ItemManager::getItemName(type)}, {"current_live_probability", p}};
+    
+    switch (type) {
+    case ItemManager::ItemType::MagnifyingGlass:
+        result["outcomes"] = QJsonArray{
+            QJsonObject{{"current", "live"}, {"probability", p}, {"best_action", "shoot_dealer"},
+                        {"expected_value", expectedValueFor(1.0, state.handsawActive, true)}},
+            QJsonObject{{"current", "blank"}, {"probability", 1.0 - p}, {"best_action", "shoot_self"},
+                        {"expected_value", expectedValueFor(0.0, state.handsawActive, false)}}};
+        break;
+    case ItemManager::ItemType::Beer: {
+        // 退出当前弹后，下一发的实弹概率取决于退出的是哪种
+        QJsonArray outcomes;
+        for (bool ejectedLive : {true, false}) {
+            GameState next = successorState(state, ejectedLive);
+            QJsonObject outcome{{"ejected", ejectedLive ? "live" : "blank"},
+                                {"probability", ejectedLive ? p : 1.0 - p}};
+            if (totalRemaining > 1) {
+                outcome["next_live_probability"] = liveProbabilityAt(next, next.currentPosition);
+            } else {
+                outcome["round_ends"] = true;
+            }
+            outcomes.append(outcome);
+        }
+        result["outcomes"] = outcomes;
+        break;
+    }
+    case ItemManager::ItemType::Inverter:
+        result["live_probability_after"] = 1.0 - p;
+        result["expected_value_shoot_dealer"] = expectedValueFor(1.0 - p, state.handsawActive, true);
+        result["expected_value_shoot_self"] = expectedValueFor(1.0 - p, state.handsawActive, false);
+        break;
+    case ItemManager::ItemType::Handsaw:
+        result["expected_value_shoot_dealer"] = expectedValueFor(p, true, true);
+        result["dealer_lethal_probability"] = state.dealerHealth <= 2 ? p : 0.0;
+        break;
+    case ItemManager::ItemType::Cigarettes:
+        result["player_health_after"] = qMin(state.playerMaxHealth, state.playerHealth + 1);
+        break;
+    case ItemManager::ItemType::ExpiredMedicine:
+        result["outcomes"] = QJsonArray{
+            QJsonObject{{"probability", 0.5}, {"player_health_after", qMin(state.playerMaxHealth, state.playerHealth + 2)}},
+            QJsonObject{{"probability", 0.5}, {"player_health_after", state.playerHealth - 1},
+                        {"lethal", state.playerHealth <= 1}}};
+        break;
+    case ItemManager::ItemType::BurnerPhone:
+        // 随机告知当前弹之后某一发，命中实弹的概率即其余位置的平均实弹概率
+        result["reveal_live_probability"] = totalRemaining > 1 ? (state.remainingLive - p) / (totalRemaining - 1) : 0.0;
+        result["positions"] = totalRemaining - 1;
+        break;
+    case ItemManager::ItemType::Handcuffs: {
+        // 庄家跳过下一回合：本发打出后仍由玩家继续射击
+        GameState afterLive = successorState(state, true);
+        double nextAfterLive = totalRemaining > 1 ? liveProbabilityAt(afterLive, afterLive.currentPosition) : 0.0;
+        result["two_consecutive_live_probability"] = p * nextAfterLive;
+        break;
+    }
+    case ItemManager::ItemType::Adrenaline: {
+        QJsonArray stealable;
+        for (const auto &item : state.dealerItems) {
+            if (!item.isUsed && item.type != ItemManager::ItemType::Adrenaline) {
+                stealable.append(item.name);
+            }
+        }
+        result["stealable_dealer_items"] = stealable;
+        break;
+    }
+    default:
+        result["note"] = "本地引擎未建模该道具";
+        break;
+    }
+    return result;
+}
+
+QList<AIClient::Tool> DecisionHelper::buildTools(const GameState &state)
+{
+    // handler按值捕获局面快照，不访问DecisionHelper成员
+    QList<AIClient::Tool> tools;
+    
+    tools.append({
+        "live_probability",
+        "计算本回合第N发子弹（从1开始的绝对位置）为实弹的概率，考虑已知子弹信息。省略position时为当前子弹",
+        QJsonObject{{"type", "object"},
+                    {"properties", QJsonObject{{"position", QJsonObject{{"type", "integer"}, {"minimum", 1}}}}}},
+        [state](const QJsonObject &arguments) {
+            int position = arguments["position"].toInt(state.currentPosition);
+            double p = liveProbabilityAt(state, position);
+            if (p < 0) {
+                return QJsonObject{{"error", QString("position must be between %1 and %2")
+                                                 .arg(state.currentPosition)
+                                                 .arg(state.currentPosition + state.remainingLive + state.remainingBlank - 1)}};
+            }
+            return QJsonObject{{"position", position}, {"live_probability", p}};
+        }
+    });
+    
+    tools.append({
+        "expected_value",
+        "计算当前这一发射击庄家或射击自己的期望值（实弹伤害对庄家为正收益，对自己为负收益），以及致死概率",
+        QJsonObject{{"type", "object"},
+                    {"properties", QJsonObject{{"action", QJsonObject{{"type", "string"},
+                                                                      {"enum", QJsonArray{"shoot_dealer", "shoot_self"}}}}}},
+                    {"required", QJsonArray{"action"}}},
+        [state](const QJsonObject &arguments) {
+            bool shootDealer = arguments["action"].toString() != "shoot_self";
+            double p = liveProbabilityAt(state, state.currentPosition);
+            int damage = state.handsawActive ? 2 : 1;
+            int targetHealth = shootDealer ? state.dealerHealth : state.playerHealth;
+            return QJsonObject{{"action", shootDealer ? "shoot_dealer" : "shoot_self"},
+                               {"live_probability", p},
+                               {"expected_value", expectedValueFor(p, state.handsawActive, shootDealer)},
+                               {"damage_if_live", shootDealer ? damage : 1},
+                               {"lethal_probability", targetHealth <= (shootDealer ? damage : 1) ? p : 0.0},
+                               {"keeps_turn_probability", shootDealer ? 0.0 : 1.0 - p}};
+        }
+    });
+    
+    QJsonArray itemNames;
+    for (int type = 0; type <= static_cast<int>(ItemManager::ItemType::Remote); ++type) {
+        itemNames.append(ItemManager::getItemName(static_cast<ItemManager::ItemType>(type)));
+    }
+    tools.append({
+        "item_outcome",
+        "计算在当前局面使用某个道具后的结果分布，例如放大镜看到实弹/空包的概率、啤酒退弹后下一发的实弹概率",
+        QJsonObject{{"type", "object"},
+                    {"properties", QJsonObject{{"item", QJsonObject{{"type", "string"}, {"enum", itemNames}}}}},
+                    {"required", QJsonArray{"item"}}},
+        [state](const QJsonObject &arguments) {
+            const QString name = arguments["item"].toString();
+            for (int type = 0; type <= static_cast<int>(ItemManager::ItemType::Remote); ++type) {
+                auto itemType = static_cast<ItemManager::ItemType>(type);
+                if (ItemManager::getItemName(itemType) == name) {
+                    return itemOutcome(state, itemType);
+                }
+            }
+            return QJsonObject{{"error", QString("unknown item: %1").arg(name)}};
+        }
+    });
+    
+    return tools;
+}
+
+void DecisionHelper::onToolCalled(const QString &name, const QJsonObject &arguments)
+{
+    ++m_toolCalls;
+    QString argumentText = QString::fromUtf8(QJsonDocument(arguments).toJson(QJsonDocument::Compact));
+    emit aiToolInfo(QString("工具调用：共 %1 次，最近 %2%3").arg(m_toolCalls).arg(name, argumentText));
+}
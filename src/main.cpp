@@ -1,44 +1,20 @@
 #include "main.h"
 #include "version.h"
+#include "logger.h"
+#include "tracer.h"
 #include <QApplication>
-#include <QFile>
-#include <QTextStream>
-#include <QDateTime>
-#include <QDebug>
-
-QFile debugLogFile;
-
-void myMessageHandler(QtMsgType type, const QMessageLogContext &context, const QString &msg)
-{
-    QTextStream out(&debugLogFile);
-    QString time = QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz");
-    QString txt;
-    switch (type) {
-    case QtDebugMsg:
-        txt = QString("[%1] Debug: %2").arg(time, msg);
-        break;
-    case QtWarningMsg:
-        txt = QString("[%1] Warning: %2").arg(time, msg);
-        break;
-    case QtCriticalMsg:
-        txt = QString("[%1] Critical: %2").arg(time, msg);
-        break;
-    case QtFatalMsg:
-        txt = QString("[%1] Fatal: %2").arg(time, msg);
-        break;
-    }
-    out << txt << "\n";
-    out.flush();
-}
 
 int main(int argc, char *argv[]) {
 #if QT_VERSION >= 0x50601
     QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
 #endif
 
-    debugLogFile.setFileName("debug.log");
-    debugLogFile.open(QIODevice::Text | QIODevice::WriteOnly);
-    qInstallMessageHandler(myMessageHandler);
+    Logger::instance().start("debug.log");
+    qInstallMessageHandler(Logger::messageHandler);
+    
+    // 设置环境变量 BRT_TRACE=<文件路径> 以记录耗时追踪，退出时导出为Chrome trace JSON
+    const QString tracePath = qEnvironmentVariable("BRT_TRACE");
+    Tracer::setEnabled(!tracePath.isEmpty());
 
     QApplication app(argc, argv);
 
@@ -50,5 +26,13 @@ int main(int argc, char *argv[]) {
     MainWindow mainWindow;
     mainWindow.show();
 
-    return app.exec();
+    int ret = app.exec();
+
+    if (Tracer::isEnabled()) {
+        Tracer::exportChromeTrace(tracePath);
+    }
+
+    qInstallMessageHandler(nullptr);
+    Logger::instance().stop();
+    return ret;
 }
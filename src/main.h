@@ -10,7 +10,7 @@
 #include <QSpinBox>
 #include <QRadioButton>
 #include <QButtonGroup>
-#include <QListWidget>
+#include <QListView>
 #include <QTextEdit>
 #include <QGroupBox>
 #include <QComboBox>
@@ -19,13 +19,15 @@
 #include <QTabWidget>
 #include <QTableWidget>
 #include <QSplitter>
-#include <random>
 
 #include "bullettracker.h"
 #include "itemmanager.h"
 #include "decisionhelper.h"
 #include "bullettypewidget.h"
 #include "aisettings.h"
+#include "itemlistmodel.h"
+#include "random.h"
+#include "metricsdialog.h"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -43,18 +45,34 @@ private slots:
     void onGetDecisionAdvice();
     void onRandomChoice();
     void onAISettingsClicked();
+    void onMetricsClicked();
     void onAIAdviceReceived(const QString &advice);
+    void onAIAdviceDelta(const QString &delta);
+    void onAIReasoningDelta(const QString &delta);
     void onAIRequestStarted();
     void onAIRequestFinished();
     void onAIError(const QString &error);
+    void onAIConnectionInfo(bool reusedConnection, bool http2);
+    void onAIAttemptFinished(int attempt, int httpStatus, qint64 elapsedMs, int retryDelayMs);
+    void onAIRequestThrottled(int waitMs);
+    void onAICacheInfo(bool hit, const AdviceCache::Stats &stats);
+    void onAISpeculationInfo(const QString &info);
+    void onAIPromptInfo(const QString &info);
+    void onAIGatingInfo(const QString &info);
+    void onAIToolInfo(const QString &info);
 
 private:
+    // AI状态栏按行显示，各类信息各占一行
+    enum AIStatusLine { GatingStatus, PromptStatus, ToolStatus, ConnectionStatus, AttemptStatus, CacheStatus, SpeculationStatus, AIStatusLineCount };
+
     void setupUI();
     void setupBulletTracker();
     void setupItemManager();
     void updateDisplay();
     void updateProbability();
-    void updateItemLists();
+    void appendAdviceText(const QString &text);
+    void applyAISettings();
+    void setAIStatus(AIStatusLine line, const QString &text);
 
     // UI组件
     QWidget *m_centralWidget;
@@ -87,19 +105,29 @@ private:
     QSpinBox *m_dealerMaxHealthSpinBox;
     QGroupBox *m_playerItemsGroup;
     QGroupBox *m_dealerItemsGroup;
-    QListWidget *m_playerItemsList;
-    QListWidget *m_dealerItemsList;
+    QListView *m_playerItemsList;
+    QListView *m_dealerItemsList;
+    ItemListModel *m_playerItemsModel;
+    ItemListModel *m_dealerItemsModel;
     QPushButton *m_aiSettingsButton;
+    QPushButton *m_metricsButton;
+    MetricsDialog *m_metricsDialog;
     QTextEdit *m_adviceTextEdit;
     QPushButton *m_getAdviceButton;
+    QLabel *m_aiStatusLabel;
+    
+    QStringList m_aiStatusLines;
+    QStringList m_attemptLog; // 当前请求每次尝试的结果与耗时
+    
+    // 流式输出时建议框当前所处的段落
+    enum class StreamSection { None, Reasoning, Content };
+    StreamSection m_streamSection;
     
     // 核心逻辑组件
     BulletTracker *m_bulletTracker;
     ItemManager *m_itemManager;
     DecisionHelper *m_decisionHelper;
     
-    // 随机数生成器
-    std::random_device m_randomDevice;
-    std::mt19937 m_randomGenerator;
-    std::uniform_real_distribution<double> m_distribution;
+    // 随机数生成器，与模拟代码共用基于计数器的实现
+    CounterRng m_rng;
 };
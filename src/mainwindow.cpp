@@ -7,19 +7,39 @@
 #include <QHeaderView>
 #include <QTimer>
 #include <QDebug>
+#include "logger.h"
+#include "tracer.h"
 #include <QSettings>
+#include <QTextCursor>
 #include <random>
 
+namespace {
+// 设置环境变量 BRT_RANDOM_SEED=<整数> 可复现随机选择的结果，否则每次启动随机取种子
+uint64_t initialRandomSeed()
+{
+    bool ok = false;
+    const quint64 seed = qEnvironmentVariable("BRT_RANDOM_SEED").toULongLong(&ok);
+    if (ok) {
+        return seed;
+    }
+    std::random_device device;
+    return static_cast<uint64_t>(device()) << 32 | device();
+}
+}
+
 // MainWindow实现
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , m_centralWidget(nullptr)
     , m_tabWidget(nullptr)
+    , m_playerItemsModel(nullptr)
+    , m_dealerItemsModel(nullptr)
+    , m_metricsDialog(nullptr)
+    , m_streamSection(StreamSection::None)
     , m_bulletTracker(nullptr)
     , m_itemManager(nullptr)
     , m_decisionHelper(nullptr)
-    , m_randomGenerator(m_randomDevice())
-    , m_distribution(0.0, 1.0)
+    , m_rng(initialRandomSeed())
 {
     setWindowTitle(QString("BuckshotRouletteTool %1").arg(PROJECT_VERSION));
     setMinimumSize(1000, 700);
@@ -42,9 +62,37 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::onAIRequestFinished);
     connect(m_decisionHelper, &DecisionHelper::aiError,
             this, &MainWindow::onAIError);
+    connect(m_decisionHelper, &DecisionHelper::aiAdviceDelta,
+            this, &MainWindow::onAIAdviceDelta);
+    connect(m_decisionHelper, &DecisionHelper::aiReasoningDelta,
+            this, &MainWindow::onAIReasoningDelta);
+    connect(m_decisionHelper, &DecisionHelper::aiConnectionInfo,
+            this, &MainWindow::onAIConnectionInfo);
+    connect(m_decisionHelper, &DecisionHelper::aiAttemptFinished,
+            this, &MainWindow::onAIAttemptFinished);
+    connect(m_decisionHelper, &DecisionHelper::aiRequestThrottled,
+            this, &MainWindow::onAIRequestThrottled);
+    connect(m_decisionHelper, &DecisionHelper::aiCacheInfo,
+            this, &MainWindow::onAICacheInfo);
+    connect(m_decisionHelper, &DecisionHelper::aiSpeculationInfo,
+            this, &MainWindow::onAISpeculationInfo);
+    connect(m_decisionHelper, &DecisionHelper::aiPromptInfo,
+            this, &MainWindow::onAIPromptInfo);
+    connect(m_decisionHelper, &DecisionHelper::aiGatingInfo,
+            this, &MainWindow::onAIGatingInfo);
+    connect(m_decisionHelper, &DecisionHelper::aiToolInfo,
+            this, &MainWindow::onAIToolInfo);
+    
+    // 开火结果确定后取消预取的失败分支；新回合或重置时全部取消
+    connect(m_bulletTracker, &BulletTracker::bulletFired, this, [this](int position, bool isLive) {
+        m_decisionHelper->resolveSpeculation(position, isLive);
+    });
+    connect(m_bulletTracker, &BulletTracker::roundStarted,
+            m_decisionHelper, &DecisionHelper::cancelSpeculation);
     
     setupUI();
     updateDisplay();
+    applyAISettings();
 }
 
 MainWindow::~MainWindow() = default;
@@ -313,7 +361,6 @@ void MainWindow::setupItemManager()
         // 连接信号
         connect(button, &QPushButton::clicked, [this, itemType = items[i].type]() {
             m_itemManager->addPlayerItem(itemType);
-            updateDisplay();
         });
         
         int row = i / 3;
@@ -327,7 +374,15 @@ void MainWindow::setupItemManager()
     QLabel *playerItemsLabel = new QLabel("已拥有道具:");
     playerLayout->addWidget(playerItemsLabel);
     
-    m_playerItemsList = new QListWidget;
+    m_playerItemsModel = new ItemListModel(m_itemManager, true, this);
+    ItemListDelegate *playerItemsDelegate = new ItemListDelegate(this);
+    connect(playerItemsDelegate, &ItemListDelegate::deleteRequested, m_itemManager, &ItemManager::removePlayerItem);
+    
+    m_playerItemsList = new QListView;
+    m_playerItemsList->setModel(m_playerItemsModel);
+    m_playerItemsList->setItemDelegate(playerItemsDelegate);
+    m_playerItemsList->setUniformItemSizes(true);
+    m_playerItemsList->setMouseTracking(true);
     m_playerItemsList->setMaximumHeight(150);
     m_playerItemsList->setAlternatingRowColors(true);
     playerLayout->addWidget(m_playerItemsList);
@@ -382,7 +437,6 @@ void MainWindow::setupItemManager()
         // 连接信号
         connect(button, &QPushButton::clicked, [this, itemType = dealerItems[i].type]() {
             m_itemManager->addDealerItem(itemType);
-            updateDisplay();
         });
         
         int row = i / 3;
@@ -396,7 +450,15 @@ void MainWindow::setupItemManager()
     QLabel *dealerItemsLabel = new QLabel("庄家道具:");
     dealerLayout->addWidget(dealerItemsLabel);
     
-    m_dealerItemsList = new QListWidget;
+    m_dealerItemsModel = new ItemListModel(m_itemManager, false, this);
+    ItemListDelegate *dealerItemsDelegate = new ItemListDelegate(this);
+    connect(dealerItemsDelegate, &ItemListDelegate::deleteRequested, m_itemManager, &ItemManager::removeDealerItem);
+    
+    m_dealerItemsList = new QListView;
+    m_dealerItemsList->setModel(m_dealerItemsModel);
+    m_dealerItemsList->setItemDelegate(dealerItemsDelegate);
+    m_dealerItemsList->setUniformItemSizes(true);
+    m_dealerItemsList->setMouseTracking(true);
     m_dealerItemsList->setMaximumHeight(150);
     m_dealerItemsList->setAlternatingRowColors(true);
     dealerLayout->addWidget(m_dealerItemsList);
@@ -425,6 +487,11 @@ void MainWindow::setupItemManager()
     connect(m_aiSettingsButton, &QPushButton::clicked, this, &MainWindow::onAISettingsClicked);
     buttonLayout->addWidget(m_aiSettingsButton);
     
+    m_metricsButton = new QPushButton("📊 请求统计");
+    m_metricsButton->setStyleSheet("QPushButton { background-color: #6c757d; color: white; font-weight: bold; padding: 10px; }");
+    connect(m_metricsButton, &QPushButton::clicked, this, &MainWindow::onMetricsClicked);
+    buttonLayout->addWidget(m_metricsButton);
+    
     adviceLayout->addLayout(buttonLayout);
     
     m_adviceTextEdit = new QTextEdit;
@@ -432,6 +499,13 @@ void MainWindow::setupItemManager()
     m_adviceTextEdit->setMaximumHeight(200);  // 限制高度以节省空间
     adviceLayout->addWidget(m_adviceTextEdit);
     
+    m_aiStatusLabel = new QLabel;
+    for (int i = 0; i < AIStatusLineCount; ++i) {
+        m_aiStatusLines.append(QString());
+    }
+    m_aiStatusLabel->setStyleSheet("QLabel { color: #666; font-size: 11px; }");
+    adviceLayout->addWidget(m_aiStatusLabel);
+    
     mainLayout->addWidget(adviceGroup);
 }
 
@@ -446,6 +520,7 @@ void MainWindow::onNewRound()
     
     m_bulletTracker->startNewRound(live, blank);
     m_itemManager->clearAllItems();
+    m_decisionHelper->resetConversation();
     
     updateDisplay();
     
@@ -466,6 +541,8 @@ void MainWindow::onAddKnownBullet()
 void MainWindow::onResetGame()
 {
     m_bulletTracker->reset();
+    m_decisionHelper->cancelSpeculation();
+    m_decisionHelper->resetConversation();
     m_itemManager->clearAllItems();
     updateDisplay();
     
@@ -479,19 +556,19 @@ void MainWindow::onCalculateProbability()
 
 void MainWindow::onGetDecisionAdvice()
 {
-    qDebug() << "=== MainWindow AI Advice Request ===";
+    logDebug(lcApp) << "=== MainWindow AI Advice Request ===";
     
     // 检查AI设置
     QSettings settings("BuckshotRouletteTool", "AI");
     QString apiUrl = settings.value("api_url", "").toString();
     QString apiKey = settings.value("api_key", "").toString();
     
-    qDebug() << "AI Settings Check:";
-    qDebug() << "  API URL:" << apiUrl;
-    qDebug() << "  API Key Empty:" << apiKey.isEmpty();
+    logDebug(lcApp) << "AI Settings Check:";
+    logDebug(lcApp) << "  API URL:" << apiUrl;
+    logDebug(lcApp) << "  API Key Empty:" << apiKey.isEmpty();
     
     if (apiUrl.isEmpty() || apiKey.isEmpty()) {
-        qDebug() << "AI settings incomplete, showing warning message";
+        logDebug(lcApp) << "AI settings incomplete, showing warning message";
         m_adviceTextEdit->setPlainText("⚠️ 请先点击\"AI设置\"按钮配置您的AI服务。\n\n需要设置：\n- API URL\n- API Key\n\n配置完成后即可获取AI决策建议。");
         return;
     }
@@ -515,14 +592,17 @@ void MainWindow::onGetDecisionAdvice()
     QString customPrompt = settings.value("custom_prompt", "").toString();
     QString model = settings.value("model", "gpt-3.5-turbo").toString();
     
-    qDebug() << "Sending game state to AI...";
+    logDebug(lcApp) << "Sending game state to AI...";
     
     // 发送AI请求
+    m_decisionHelper->setStreamingEnabled(settings.value("stream", false).toBool());
     m_decisionHelper->getAIAdvice(state, apiUrl, apiKey, model, customPrompt);
 }
 
 void MainWindow::updateDisplay()
 {
+    TRACE_SCOPE("MainWindow::updateDisplay");
+    
     // 更新子弹状态标签
     m_remainingLiveLabel->setText(QString::number(m_bulletTracker->getRemainingLive()));
     m_remainingBlankLabel->setText(QString::number(m_bulletTracker->getRemainingBlank()));
@@ -541,7 +621,7 @@ void MainWindow::updateDisplay()
         const auto& known = m_bulletTracker->getKnownBullets();
         int currentPos = m_bulletTracker->getCurrentPosition();
         
-        qDebug() << "updateDisplay: totalBullets=" << totalBullets 
+        logDebug(lcApp) << "updateDisplay: totalBullets=" << totalBullets 
                  << "currentPos=" << currentPos 
                  << "historySize=" << history.size();
         
@@ -681,9 +761,6 @@ void MainWindow::updateDisplay()
     bool hasRound = (m_bulletTracker->getRemainingLive() + m_bulletTracker->getRemainingBlank()) > 0;
     m_getAdviceButton->setEnabled(hasRound);
     m_randomChoiceButton->setEnabled(hasRound);
-    
-    // 更新道具列表
-    updateItemLists();
 }
 
 void MainWindow::updateProbability()
@@ -707,123 +784,6 @@ void MainWindow::updateProbability()
     m_probabilityBar->setStyleSheet(QString("QProgressBar::chunk { background-color: %1; }").arg(color));
 }
 
-void MainWindow::updateItemLists()
-{
-    // 更新玩家道具列表
-    m_playerItemsList->clear();
-    const auto& playerItems = m_itemManager->getPlayerItems();
-    for (int i = 0; i < playerItems.size(); ++i) {
-        const auto& item = playerItems[i];
-        
-        // 创建自定义widget包含道具名称和删除按钮
-        QWidget* itemWidget = new QWidget;
-        QHBoxLayout* itemLayout = new QHBoxLayout(itemWidget);
-        itemLayout->setContentsMargins(5, 2, 5, 2);
-        
-        // 道具名称标签
-        QLabel* nameLabel = new QLabel;
-        QString itemText = item.name;
-        if (item.isUsed) {
-            itemText += " (已使用)";
-            nameLabel->setStyleSheet("color: gray; text-decoration: line-through;");
-        } else {
-            nameLabel->setStyleSheet("color: darkgreen; font-weight: bold;");
-        }
-        nameLabel->setText(itemText);
-        nameLabel->setToolTip(item.description);
-        
-        // 删除按钮
-        QPushButton* deleteBtn = new QPushButton("❌");
-        deleteBtn->setMaximumSize(25, 25);
-        deleteBtn->setStyleSheet(
-            "QPushButton {"
-            // "    background-color: #DC3545;"
-            "    color: white;"
-            "    border: none;"
-            "    border-radius: 3px;"
-            "    font-size: 12px;"
-            "}"
-            "QPushButton:hover {"
-            // "    background-color: #C82333;"
-            "}"
-        );
-        deleteBtn->setToolTip("删除此道具");
-        
-        // 连接删除信号
-        connect(deleteBtn, &QPushButton::clicked, [this, i]() {
-            m_itemManager->removePlayerItem(i);
-            updateDisplay();
-        });
-        
-        itemLayout->addWidget(nameLabel);
-        itemLayout->addStretch();
-        itemLayout->addWidget(deleteBtn);
-        
-        // 添加到列表
-        QListWidgetItem* listItem = new QListWidgetItem;
-        listItem->setSizeHint(itemWidget->sizeHint());
-        m_playerItemsList->addItem(listItem);
-        m_playerItemsList->setItemWidget(listItem, itemWidget);
-    }
-    
-    // 更新庄家道具列表
-    m_dealerItemsList->clear();
-    const auto& dealerItems = m_itemManager->getDealerItems();
-    for (int i = 0; i < dealerItems.size(); ++i) {
-        const auto& item = dealerItems[i];
-        
-        // 创建自定义widget包含道具名称和删除按钮
-        QWidget* itemWidget = new QWidget;
-        QHBoxLayout* itemLayout = new QHBoxLayout(itemWidget);
-        itemLayout->setContentsMargins(5, 2, 5, 2);
-        
-        // 道具名称标签
-        QLabel* nameLabel = new QLabel;
-        QString itemText = item.name;
-        if (item.isUsed) {
-            itemText += " (已使用)";
-            nameLabel->setStyleSheet("color: gray; text-decoration: line-through;");
-        } else {
-            nameLabel->setStyleSheet("color: darkred; font-weight: bold;");
-        }
-        nameLabel->setText(itemText);
-        nameLabel->setToolTip(item.description);
-        
-        // 删除按钮
-        QPushButton* deleteBtn = new QPushButton("❌");
-        deleteBtn->setMaximumSize(25, 25);
-        deleteBtn->setStyleSheet(
-            "QPushButton {"
-            // "    background-color: #DC3545;"
-            "    color: white;"
-            "    border: none;"
-            "    border-radius: 3px;"
-            "    font-size: 12px;"
-            "}"
-            "QPushButton:hover {"
-            // "    background-color: #C82333;"
-            "}"
-        );
-        deleteBtn->setToolTip("删除此道具");
-        
-        // 连接删除信号
-        connect(deleteBtn, &QPushButton::clicked, [this, i]() {
-            m_itemManager->removeDealerItem(i);
-            updateDisplay();
-        });
-        
-        itemLayout->addWidget(nameLabel);
-        itemLayout->addStretch();
-        itemLayout->addWidget(deleteBtn);
-        
-        // 添加到列表
-        QListWidgetItem* listItem = new QListWidgetItem;
-        listItem->setSizeHint(itemWidget->sizeHint());
-        m_dealerItemsList->addItem(listItem);
-        m_dealerItemsList->setItemWidget(listItem, itemWidget);
-    }
-}
-
 void MainWindow::onRandomChoice()
 {
     // 检查是否有剩余子弹
@@ -837,7 +797,8 @@ void MainWindow::onRandomChoice()
     double liveProbability = m_bulletTracker->getLiveProbability();
     
     // 生成随机数 (0.0 到 1.0)
-    double randomValue = m_distribution(m_randomGenerator);
+    logDebug(lcApp) << "Random choice draw at position" << m_rng.position() << "seed" << m_rng.seed();
+    double randomValue = m_rng.uniform();
     
     // 根据概率决定子弹类型
     bool isLive = randomValue < liveProbability;
@@ -866,23 +827,95 @@ void MainWindow::onRandomChoice()
 void MainWindow::onAISettingsClicked()
 {
     AISettings settingsDialog(this);
+    connect(&settingsDialog, &AISettings::clearCacheRequested,
+            m_decisionHelper, &DecisionHelper::clearAdviceCache);
     if (settingsDialog.exec() == QDialog::Accepted) {
+        applyAISettings();
         // 设置已保存，显示成功消息
         m_adviceTextEdit->setPlainText("✅ AI设置已保存！\n\n现在您可以点击\"获取AI建议\"按钮来获取基于当前游戏状态的AI决策分析。\n\nAI将运用概率论和博弈论为您提供最优策略建议。");
     }
 }
 
+void MainWindow::onMetricsClicked()
+{
+    // 非模态打开，请求完成时随数据刷新
+    if (!m_metricsDialog) {
+        m_metricsDialog = new MetricsDialog(&m_decisionHelper->metrics(), this);
+        connect(m_decisionHelper, &DecisionHelper::aiMetricsUpdated, m_metricsDialog, &MetricsDialog::refresh);
+        connect(m_metricsDialog, &MetricsDialog::clearRequested, m_decisionHelper, &DecisionHelper::clearMetrics);
+    }
+    m_metricsDialog->refresh();
+    m_metricsDialog->show();
+    m_metricsDialog->raise();
+    m_metricsDialog->activateWindow();
+}
+
+void MainWindow::applyAISettings()
+{
+    QSettings settings("BuckshotRouletteTool", "AI");
+    QString apiUrl = settings.value("api_url", "").toString();
+    QString apiKey = settings.value("api_key", "").toString();
+    QString model = settings.value("model", "gpt-3.5-turbo").toString();
+    m_decisionHelper->configureAI(apiUrl, apiKey, model);
+    m_decisionHelper->setCacheEnabled(settings.value("cache_enabled", true).toBool());
+    m_decisionHelper->setCompactPrompt(settings.value("compact_prompt", false).toBool());
+    m_decisionHelper->setHybridMode(settings.value("hybrid_mode", false).toBool());
+    m_decisionHelper->setToolCallingEnabled(settings.value("tool_calling", false).toBool());
+    m_decisionHelper->setConversationMode(settings.value("conversation_mode", false).toBool());
+    m_decisionHelper->setBackupEndpoints(AISettings::readBackupEndpoints(settings),
+                                         settings.value("hedge_enabled", false).toBool(),
+                                         settings.value("hedge_percentile", 90).toInt());
+    m_decisionHelper->setSpeculativePrefetch(settings.value("speculative_enabled", false).toBool());
+    m_decisionHelper->setRetryPolicy(settings.value("max_retries", 3).toInt(),
+                                     settings.value("requests_per_minute", 0).toInt());
+    m_decisionHelper->setMaxConcurrentRequests(settings.value("max_concurrent", 4).toInt());
+}
+
 void MainWindow::onAIAdviceReceived(const QString &advice)
 {
-    qDebug() << "=== AI Advice Received ===";
-    qDebug() << "Advice Length:" << advice.length() << "chars";
-    qDebug() << "Advice Content:" << advice;
+    logDebug(lcApp) << "=== AI Advice Received ===";
+    logDebug(lcApp) << "Advice Length:" << advice.length() << "chars";
+    logTrace(lcApp) << "Advice Content:" << advice;
     m_adviceTextEdit->setPlainText(advice);
 }
 
+void MainWindow::onAIAdviceDelta(const QString &delta)
+{
+    if (m_streamSection == StreamSection::None) {
+        m_adviceTextEdit->clear();
+    } else if (m_streamSection == StreamSection::Reasoning) {
+        appendAdviceText("\n正式回答：\n");
+    }
+    m_streamSection = StreamSection::Content;
+    appendAdviceText(delta);
+}
+
+void MainWindow::onAIReasoningDelta(const QString &delta)
+{
+    if (m_streamSection != StreamSection::Reasoning) {
+        if (m_streamSection == StreamSection::None) {
+            m_adviceTextEdit->clear();
+        }
+        appendAdviceText("深度思考：\n");
+        m_streamSection = StreamSection::Reasoning;
+    }
+    appendAdviceText(delta);
+}
+
+void MainWindow::appendAdviceText(const QString &text)
+{
+    // 只在末尾追加，避免每个增量都重新布局整个文档
+    m_adviceTextEdit->moveCursor(QTextCursor::End);
+    m_adviceTextEdit->insertPlainText(text);
+    m_adviceTextEdit->ensureCursorVisible();
+}
+
 void MainWindow::onAIRequestStarted()
 {
-    qDebug() << "=== AI Request Started ===";
+    logDebug(lcApp) << "=== AI Request Started ===";
+    m_streamSection = StreamSection::None;
+    m_attemptLog.clear();
+    setAIStatus(AttemptStatus, QString());
     m_getAdviceButton->setEnabled(false);
     m_getAdviceButton->setText("🤖 AI思考中...");
     m_adviceTextEdit->setPlainText("🤖 AI正在分析当前游戏状态...\n\n请稍等，这可能需要几秒钟时间。\n\n分析内容：\n- 概率论计算\n- 博弈论策略\n- 风险评估\n- 最优决策建议");
@@ -890,14 +923,79 @@ void MainWindow::onAIRequestStarted()
 
 void MainWindow::onAIRequestFinished()
 {
-    qDebug() << "=== AI Request Finished ===";
+    logDebug(lcApp) << "=== AI Request Finished ===";
     m_getAdviceButton->setEnabled(true);
     m_getAdviceButton->setText("🤖 获取AI建议");
 }
 
+void MainWindow::onAIConnectionInfo(bool reusedConnection, bool http2)
+{
+    setAIStatus(ConnectionStatus, QString("连接：%1 · %2")
+        .arg(reusedConnection ? "复用预热连接" : "新建连接", http2 ? "HTTP/2" : "HTTP/1.1"));
+}
+
+void MainWindow::onAIAttemptFinished(int attempt, int httpStatus, qint64 elapsedMs, int retryDelayMs)
+{
+    QString entry = QString("#%1 %2 %3ms")
+        .arg(attempt).arg(httpStatus > 0 ? QString("HTTP %1").arg(httpStatus) : QString("网络错误")).arg(elapsedMs);
+    if (retryDelayMs >= 0) {
+        entry += QString(" → %1秒后重试").arg(retryDelayMs / 1000.0, 0, 'f', 1);
+    }
+    m_attemptLog.append(entry);
+    setAIStatus(AttemptStatus, "请求：" + m_attemptLog.join(" | "));
+}
+
+void MainWindow::onAIRequestThrottled(int waitMs)
+{
+    QStringList lines = m_attemptLog;
+    lines.append(QString("已达每分钟请求上限，%1秒后发送").arg(waitMs / 1000.0, 0, 'f', 1));
+    setAIStatus(AttemptStatus, "请求：" + lines.join(" | "));
+}
+
+void MainWindow::onAICacheInfo(bool hit, const AdviceCache::Stats &stats)
+{
+    setAIStatus(CacheStatus, QString("%1（缓存命中率 %2%，%3/%4）")
+        .arg(hit ? "⚡ 缓存命中，未请求AI" : "缓存未命中，正在请求AI")
+        .arg(stats.hitRate() * 100, 0, 'f', 1)
+        .arg(stats.hits()).arg(stats.lookups));
+}
+
+void MainWindow::onAISpeculationInfo(const QString &info)
+{
+    setAIStatus(SpeculationStatus, info);
+}
+
+void MainWindow::onAIPromptInfo(const QString &info)
+{
+    setAIStatus(PromptStatus, info);
+}
+
+void MainWindow::onAIGatingInfo(const QString &info)
+{
+    setAIStatus(GatingStatus, info);
+}
+
+void MainWindow::onAIToolInfo(const QString &info)
+{
+    setAIStatus(ToolStatus, info);
+}
+
+void MainWindow::setAIStatus(AIStatusLine line, const QString &text)
+{
+    m_aiStatusLines[line] = text;
+    
+    QStringList visible;
+    for (const QString &statusLine : m_aiStatusLines) {
+        if (!statusLine.isEmpty()) {
+            visible.append(statusLine);
+        }
+    }
+    m_aiStatusLabel->setText(visible.join("\n"));
+}
+
 void MainWindow::onAIError(const QString &error)
 {
-    qDebug() << "=== AI Request Error ===";
-    qDebug() << "Error Message:" << error;
+    logDebug(lcApp) << "=== AI Request Error ===";
+    logDebug(lcApp) << "Error Message:" << error;
     m_adviceTextEdit->setPlainText(QString("❌ AI请求失败\n\n错误信息：%1\n\n解决建议：\n- 检查网络连接\n- 验证API设置是否正确\n- 确认API密钥有效\n- 稍后重试").arg(error));
 }
@@ -0,0 +1,136 @@
+#include "metricsdialog.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QFileDialog>
+#include <QFontDatabase>
+#include <QMessageBox>
+#include <QStandardPaths>
+#include <algorithm>
+
+MetricsDialog::MetricsDialog(const AIMetrics *metrics, QWidget *parent)
+    : QDialog(parent)
+    , m_metrics(metrics)
+{
+    setWindowTitle("AI请求统计");
+    setMinimumSize(560, 480);
+
+    setupUI();
+    refresh();
+
+    connect(m_metricCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &MetricsDialog::updateHistogram);
+    connect(m_exportButton, &QPushButton::clicked, this, &MetricsDialog::onExportClicked);
+    connect(m_clearButton, &QPushButton::clicked, this, &MetricsDialog::clearRequested);
+    connect(m_closeButton, &QPushButton::clicked, this, &QDialog::close);
+}
+
+void MetricsDialog::setupUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    m_summaryLabel = new QLabel;
+    mainLayout->addWidget(m_summaryLabel);
+
+    // 各指标分位数汇总
+    m_table = new QTableWidget(AIMetrics::MetricCount, 6);
+    m_table->setHorizontalHeaderLabels({"样本", "P50", "P90", "P99", "最大", "单位"});
+    for (int metric = 0; metric < AIMetrics::MetricCount; ++metric) {
+        m_table->setVerticalHeaderItem(metric, new QTableWidgetItem(AIMetrics::metricName(static_cast<AIMetrics::Metric>(metric))));
+    }
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    mainLayout->addWidget(m_table);
+
+    // 单项指标直方图
+    QHBoxLayout *histogramLayout = new QHBoxLayout;
+    histogramLayout->addWidget(new QLabel("直方图:"));
+    m_metricCombo = new QComboBox;
+    for (int metric = 0; metric < AIMetrics::MetricCount; ++metric) {
+        m_metricCombo->addItem(AIMetrics::metricName(static_cast<AIMetrics::Metric>(metric)));
+    }
+    m_metricCombo->setCurrentIndex(AIMetrics::Total);
+    histogramLayout->addWidget(m_metricCombo);
+    histogramLayout->addStretch();
+    mainLayout->addLayout(histogramLayout);
+
+    m_histogramView = new QPlainTextEdit;
+    m_histogramView->setReadOnly(true);
+    m_histogramView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    mainLayout->addWidget(m_histogramView);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    m_exportButton = new QPushButton("导出CSV");
+    m_clearButton = new QPushButton("清空");
+    buttonLayout->addWidget(m_exportButton);
+    buttonLayout->addWidget(m_clearButton);
+    buttonLayout->addStretch();
+    m_closeButton = new QPushButton("关闭");
+    buttonLayout->addWidget(m_closeButton);
+    mainLayout->addLayout(buttonLayout);
+}
+
+void MetricsDialog::refresh()
+{
+    const QList<RequestMetrics> &records = m_metrics->records();
+    int background = static_cast<int>(std::count_if(records.begin(), records.end(),
+                                                    [](const RequestMetrics &m) { return m.background; }));
+    m_summaryLabel->setText(QString("请求 %1 次（后台预取 %2），失败 %3，重试 %4 次")
+        .arg(records.size()).arg(background).arg(m_metrics->failureCount()).arg(m_metrics->retryCount()));
+
+    for (int row = 0; row < AIMetrics::MetricCount; ++row) {
+        auto metric = static_cast<AIMetrics::Metric>(row);
+        const QList<qint64> values = m_metrics->values(metric);
+        auto cell = [](qint64 value) { return value < 0 ? QString("-") : QString::number(value); };
+        QStringList cells = {QString::number(values.size()),
+                             cell(AIMetrics::percentile(values, 50)),
+                             cell(AIMetrics::percentile(values, 90)),
+                             cell(AIMetrics::percentile(values, 99)),
+                             cell(values.isEmpty() ? -1 : values.last()),
+                             AIMetrics::isTiming(metric) ? "ms" : "token"};
+        for (int column = 0; column < cells.size(); ++column) {
+            m_table->setItem(row, column, new QTableWidgetItem(cells[column]));
+        }
+    }
+
+    updateHistogram();
+}
+
+void MetricsDialog::updateHistogram()
+{
+    auto metric = static_cast<AIMetrics::Metric>(m_metricCombo->currentIndex());
+    const QList<AIMetrics::Bucket> buckets = m_metrics->histogram(metric);
+    const QString unit = AIMetrics::isTiming(metric) ? "ms" : "";
+
+    int maxCount = 0;
+    for (const auto &bucket : buckets) {
+        maxCount = qMax(maxCount, bucket.count);
+    }
+
+    const int BAR_WIDTH = 40;
+    QStringList lines;
+    qint64 lowerBound = 0;
+    for (const auto &bucket : buckets) {
+        QString label = bucket.upperBound < 0 ? QString("> %1%2").arg(lowerBound).arg(unit)
+                                              : QString("≤ %1%2").arg(bucket.upperBound).arg(unit);
+        int barLength = maxCount > 0 ? (bucket.count * BAR_WIDTH + maxCount - 1) / maxCount : 0;
+        lines.append(QString("%1 │%2 %3").arg(label, 10).arg(QString(barLength, QChar(0x2588))).arg(bucket.count));
+        lowerBound = bucket.upperBound;
+    }
+    m_histogramView->setPlainText(lines.join('\n'));
+}
+
+void MetricsDialog::onExportClicked()
+{
+    QString defaultPath = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/ai_metrics.csv";
+    QString filePath = QFileDialog::getSaveFileName(this, "导出请求统计", defaultPath, "CSV文件 (*.csv)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    QString error;
+    if (m_metrics->exportCsv(filePath, &error)) {
+        QMessageBox::information(this, "导出完成", QString("已导出 %1 条记录").arg(m_metrics->records().size()));
+    } else {
+        QMessageBox::warning(this, "导出失败", error);
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QDialog>
+#include <QTableWidget>
+#include <QComboBox>
+#include <QPlainTextEdit>
+#include <QLabel>
+#include <QPushButton>
+#include "aimetrics.h"
+
+// AI请求遥测面板：各阶段分位数汇总、单项指标直方图，可导出CSV
+class MetricsDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    explicit MetricsDialog(const AIMetrics *metrics, QWidget *parent = nullptr);
+
+public slots:
+    void refresh();
+
+signals:
+    void clearRequested();
+
+private slots:
+    void onExportClicked();
+
+private:
+    void setupUI();
+    void updateHistogram();
+
+    const AIMetrics *m_metrics;
+    QLabel *m_summaryLabel;
+    QTableWidget *m_table;
+    QComboBox *m_metricCombo;
+    QPlainTextEdit *m_histogramView;
+    QPushButton *m_exportButton;
+    QPushButton *m_clearButton;
+    QPushButton *m_closeButton;
+};
@@ -0,0 +1,148 @@
+#include "parallelsolver.h"
+
+struct ParallelSolver::Child {
+    ParallelSolver *solver;
+    Position position;
+    double value;
+};
+
+ParallelSolver::ParallelSolver(int threads, TranspositionTable *shared)
+    : m_pool(threads)
+    , m_shared(shared)
+{
+    for (int i = 0; i < m_pool.participants(); ++i) {
+        m_solvers.push_back(std::make_unique<Solver>(shared));
+    }
+}
+
+ParallelSolver &ParallelSolver::shared()
+{
+    static ParallelSolver solver;
+    return solver;
+}
+
+int ParallelSolver::remainingWork(const Position &position)
+{
+    int remaining = position.shells();
+    for (int side = 0; side < 2; ++side) {
+        for (int item = 0; item < ITEM_KINDS; ++item) {
+            remaining += position.items[side][item];
+        }
+    }
+    return remaining;
+}
+
+ParallelSolver::Result ParallelSolver::solve(const Position &position)
+{
+    // 每次查询开始时收回各参与者上一次查询的结点
+    for (const auto &solver : m_solvers) {
+        solver->clear();
+    }
+    m_expanded = 0;
+    m_spawned = 0;
+    const uint64_t stealsBefore = m_pool.steals();
+
+    Result result;
+    m_pool.run([&]() { result = expand(position); });
+
+    m_nodes = m_expanded;
+    for (const auto &solver : m_solvers) {
+        m_nodes += solver->nodes();
+    }
+    m_tasks = m_spawned;
+    m_steals = m_pool.steals() - stealsBefore;
+    return result;
+}
+
+double ParallelSolver::value(const Position &position)
+{
+    if (remainingWork(position) <= m_grain) {
+        return m_solvers[m_pool.currentParticipant()]->value(position);
+    }
+    const uint64_t key = position.key();
+    double value = 0.0;
+    if (m_shared && m_shared->probe(key, value)) {
+        return value;
+    }
+    value = expand(position).value;
+    if (m_shared) {
+        m_shared->store(key, value);
+    }
+    return value;
+}
+
+void ParallelSolver::evaluateChild(void *context)
+{
+    Child &child = *static_cast<Child *>(context);
+    child.value = child.solver->value(child.position);
+}
+
+ParallelSolver::Result ParallelSolver::expand(const Position &position)
+{
+    m_expanded.fetch_add(1, std::memory_order_relaxed);
+
+    // 第一遍：派生所有行动的所有继续对局的后继
+    Child children[ACTION_KINDS * GameRules::MAX_OUTCOMES];
+    int childCount = 0;
+    Outcome outcomes[GameRules::MAX_OUTCOMES];
+    WorkStealingPool::Group group;
+    for (int a = 0; a < ACTION_KINDS; ++a) {
+        const auto action = static_cast<Action>(a);
+        if (!GameRules::isLegal(position, action)) {
+            continue;
+        }
+        const int count = GameRules::outcomes(position, action, outcomes);
+        for (int i = 0; i < count; ++i) {
+            if (outcomes[i].result == Outcome::Continue) {
+                children[childCount] = {this, outcomes[i].next, 0.0};
+                m_pool.spawn(group, {&ParallelSolver::evaluateChild, &children[childCount]});
+                ++childCount;
+            }
+        }
+    }
+    m_spawned.fetch_add(childCount, std::memory_order_relaxed);
+    m_pool.wait(group);
+
+    // 第二遍：按与Solver::solve相同的顺序合并，保证结果逐位一致
+    Result result{Action::ShootOpponent, -1.0, -1.0};
+    int next = 0;
+    for (int a = 0; a < ACTION_KINDS; ++a) {
+        const auto action = static_cast<Action>(a);
+        if (!GameRules::isLegal(position, action)) {
+            continue;
+        }
+        const int count = GameRules::outcomes(position, action, outcomes);
+        double value = 0.0;
+        for (int i = 0; i < count; ++i) {
+            const Outcome &outcome = outcomes[i];
+            double childValue = 0.0;
+            switch (outcome.result) {
+            case Outcome::Win:
+                childValue = 1.0;
+                break;
+            case Outcome::Loss:
+                childValue = 0.0;
+                break;
+            case Outcome::RoundOver:
+                childValue = GameRules::roundOverValue(outcome.next.health[0], outcome.next.health[1]);
+                break;
+            case Outcome::Continue:
+                childValue = outcome.turnPassed ? 1.0 - children[next].value : children[next].value;
+                ++next;
+                break;
+            }
+            value += outcome.probability * childValue;
+        }
+        if (value > result.value) {
+            result.runnerUp = result.value;
+            result.best = action;
+            result.value = value;
+        } else if (value > result.runnerUp) {
+            result.runnerUp = value;
+        }
+    }
+    if (result.runnerUp < 0.0) {
+        result.runnerUp = result.value;
+    }
+    return result;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "gamemodel.h"
+#include "solver.h"
+#include "transpositiontable.h"
+#include "workstealingpool.h"
+
+// 并行的期望极大极小搜索：剩余子弹与道具较多的局面把各行动的所有机会结局（实弹/空包弹、
+// 手机揭示的位置、过期药的两种结果）作为独立任务派生到工作窃取线程池；
+// 不超过粒度的子树由各参与者自己的Solver顺序搜索，避免小任务的调度开销压过收益。
+// 各参与者经共享置换表交换结果；合并顺序与Solver相同，结果与单线程搜索逐位一致。
+class ParallelSolver {
+public:
+    struct Result {
+        Action best = Action::ShootOpponent;
+        double value = 0.0;    // 行动方胜率
+        double runnerUp = 0.0; // 次优行动的胜率，只有一个合法行动时等于value
+    };
+
+    // 剩余子弹与道具合计不超过粒度的子树顺序搜索
+    static constexpr int DEFAULT_GRAIN = 9;
+
+    // threads为参与者总数（含调用solve的线程），0表示硬件线程数
+    explicit ParallelSolver(int threads = 0, TranspositionTable *shared = &TranspositionTable::shared());
+
+    // 根局面必须有子弹；同一时刻只处理一个查询
+    Result solve(const Position &position);
+
+    void setGrain(int grain) { m_grain = grain; }
+    int grain() const { return m_grain; }
+    int threads() const { return m_pool.participants(); }
+
+    // 上一次查询的统计：展开的结点数（并行展开与顺序搜索合计）、派生的任务数、窃取次数
+    uint64_t nodes() const { return m_nodes; }
+    uint64_t tasks() const { return m_tasks; }
+    uint64_t steals() const { return m_steals; }
+
+    static int remainingWork(const Position &position);
+
+    // 进程内共用的并行搜索器，首次使用时创建
+    static ParallelSolver &shared();
+
+private:
+    struct Child;
+
+    double value(const Position &position);
+    // 展开一个大局面：派生全部后继、等待、按Solver的顺序合并
+    Result expand(const Position &position);
+    static void evaluateChild(void *context);
+
+    WorkStealingPool m_pool;
+    std::vector<std::unique_ptr<Solver>> m_solvers; // 每个参与者一个，结点池互不共享
+    TranspositionTable *m_shared;
+    int m_grain = DEFAULT_GRAIN;
+    std::atomic<uint64_t> m_expanded{0};
+    std::atomic<uint64_t> m_spawned{0};
+    uint64_t m_nodes = 0;
+    uint64_t m_tasks = 0;
+    uint64_t m_steals = 0;
+};
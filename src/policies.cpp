@@ -0,0 +1,76 @@
+#include "policies.h"
+#include "solver.h"
+
+namespace {
+const PolicyInfo POLICIES[] = {
+    {"threshold", "实弹概率阈值（recommendAction）", &Policies::threshold},
+    {"ev", "期望值比较（calculateExpectedValue）", &Policies::expectedValueComparison},
+    {"random", "按实弹概率随机（🎲随机选择）", &Policies::weightedRandom},
+    {"dealer", "庄家：放大镜/香烟/手锯后按概率过半射击", &Policies::dealer},
+    {"coin", "抛硬币", &Policies::coinFlip},
+    {"search", "期望极大极小搜索（Solver）", &Policies::search},
+};
+}
+
+std::span<const PolicyInfo> Policies::registered()
+{
+    return POLICIES;
+}
+
+const PolicyInfo *Policies::find(std::string_view name)
+{
+    for (const PolicyInfo &policy : POLICIES) {
+        if (name == policy.name) {
+            return &policy;
+        }
+    }
+    return nullptr;
+}
+
+Action Policies::threshold(const Position &position, CounterRng &rng)
+{
+    const double liveProbability = position.liveProbability();
+    if (liveProbability >= HIGH_LIVE_PROBABILITY) {
+        return Action::ShootOpponent;
+    }
+    if (liveProbability <= LOW_LIVE_PROBABILITY) {
+        return Action::ShootSelf;
+    }
+    return expectedValueComparison(position, rng);
+}
+
+Action Policies::expectedValueComparison(const Position &position, CounterRng &)
+{
+    const double liveProbability = position.liveProbability();
+    return expectedValue(liveProbability, position.sawActive, true) > expectedValue(liveProbability, position.sawActive, false)
+        ? Action::ShootOpponent : Action::ShootSelf;
+}
+
+Action Policies::weightedRandom(const Position &position, CounterRng &rng)
+{
+    return rng.uniform() < position.liveProbability() ? Action::ShootOpponent : Action::ShootSelf;
+}
+
+Action Policies::dealer(const Position &position, CounterRng &)
+{
+    for (Item item : {Item::MagnifyingGlass, Item::Cigarettes}) {
+        if (GameRules::isLegal(position, useItem(item))) {
+            return useItem(item);
+        }
+    }
+    const double liveProbability = position.liveProbability();
+    if (liveProbability == 1.0 && GameRules::isLegal(position, useItem(Item::Handsaw))) {
+        return useItem(Item::Handsaw);
+    }
+    return liveProbability >= 0.5 ? Action::ShootOpponent : Action::ShootSelf;
+}
+
+Action Policies::coinFlip(const Position &, CounterRng &rng)
+{
+    return rng.below(2) == 0 ? Action::ShootOpponent : Action::ShootSelf;
+}
+
+Action Policies::search(const Position &position, CounterRng &)
+{
+    return Solver::forThisThread().solve(position).best;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <span>
+#include <string_view>
+#include "gamemodel.h"
+#include "random.h"
+
+// 决策策略：输入行动方视角的局面，返回一个合法行动。
+// 竞技场按名称查找策略；庄家策略也在此注册，可作为任一方使用。
+struct PolicyInfo {
+    const char *name;
+    const char *description;
+    Action (*choose)(const Position &position, CounterRng &rng);
+};
+
+class Policies {
+public:
+    // DecisionHelper::recommendAction使用的实弹概率阈值
+    static constexpr double HIGH_LIVE_PROBABILITY = 0.7;
+    static constexpr double LOW_LIVE_PROBABILITY = 0.3;
+
+    // DecisionHelper::calculateExpectedValue的一步期望值（血量变化，射击对手时空包弹有小惩罚）
+    static constexpr double expectedValue(double liveProbability, bool handsawActive, bool shootOpponent)
+    {
+        if (shootOpponent) {
+            const double damageMultiplier = handsawActive ? 2.0 : 1.0;
+            return liveProbability * damageMultiplier - (1.0 - liveProbability) * 0.1;
+        }
+        return (1.0 - liveProbability) * 1.0 - liveProbability * 2.0;
+    }
+
+    static std::span<const PolicyInfo> registered();
+    static const PolicyInfo *find(std::string_view name);
+
+    // recommendAction：当前子弹已知时按类型行动，否则按阈值，中间区域比较期望值
+    static Action threshold(const Position &position, CounterRng &rng);
+    // calculateExpectedValue：直接比较两种射击的期望值
+    static Action expectedValueComparison(const Position &position, CounterRng &rng);
+    // 🎲随机选择：按实弹概率抽签，抽到实弹射击对手，否则射击自己
+    static Action weightedRandom(const Position &position, CounterRng &rng);
+    // 庄家：先用放大镜、香烟、已知实弹时用手锯，再按实弹概率过半射击对手
+    static Action dealer(const Position &position, CounterRng &rng);
+    static Action coinFlip(const Position &position, CounterRng &rng);
+    // 本地搜索引擎的最优行动，每个线程保留各自的求解缓存
+    static Action search(const Position &position, CounterRng &rng);
+};
@@ -0,0 +1,17 @@
+#include "policytable.h"
+
+namespace {
+#include "policytable.inc"
+
+const PolicyTable::Layout EMBEDDED{POLICY_TABLE_SALT, POLICY_TABLE_SEEDS, POLICY_TABLE_FINGERPRINTS, POLICY_TABLE_ANSWERS};
+}
+
+const PolicyTable::Layout &PolicyTable::embedded()
+{
+    return EMBEDDED;
+}
+
+std::optional<PolicyTable::Answer> PolicyTable::probe(const Position &position)
+{
+    return probe(EMBEDDED, position.key());
+}
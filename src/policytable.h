@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include "gamemodel.h"
+
+// 编译进程序的已解局面表：对规范键做最小完美哈希（哈希-位移法），查询无搜索、无文件读写。
+// 数据由PolicyTableGen求解常见局面后生成到policytable.inc；未收录的局面由键指纹拒绝。
+class PolicyTable {
+public:
+    struct Answer {
+        Action best;
+        double value; // 行动方胜率
+    };
+
+    struct Layout {
+        uint64_t salt;
+        std::span<const uint16_t> seeds;        // 每个桶的位移种子
+        std::span<const uint32_t> fingerprints; // 每个槽的键指纹
+        std::span<const uint16_t> answers;      // 低4位为行动，高12位为量化胜率
+    };
+
+    static const Layout &embedded();
+    static std::optional<Answer> probe(const Position &position);
+    static size_t sizeBytes(const Layout &layout)
+    {
+        return layout.seeds.size_bytes() + layout.fingerprints.size_bytes() + layout.answers.size_bytes();
+    }
+
+    // 生成器也用它校验新表，因此不依赖内嵌数据
+    static std::optional<Answer> probe(const Layout &layout, uint64_t key)
+    {
+        if (layout.fingerprints.empty()) {
+            return std::nullopt;
+        }
+        const uint16_t seed = layout.seeds[bucketOf(key, layout.salt, layout.seeds.size())];
+        const size_t slot = slotOf(key, layout.salt, seed, layout.fingerprints.size());
+        if (layout.fingerprints[slot] != fingerprintOf(key, layout.salt)) {
+            return std::nullopt;
+        }
+        return decode(layout.answers[slot]);
+    }
+
+    // 以下哈希与编码由生成器和查询共用
+    static constexpr int VALUE_BITS = 12;
+    static constexpr uint32_t VALUE_SCALE = (1u << VALUE_BITS) - 1;
+
+    static constexpr uint64_t mix(uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ull;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBull;
+        return x ^ x >> 31;
+    }
+
+    // 取哈希高32位映射到[0,range)，避免取模
+    static constexpr size_t reduce(uint64_t hash, size_t range)
+    {
+        return static_cast<size_t>((hash >> 32) * range >> 32);
+    }
+
+    static constexpr size_t bucketOf(uint64_t key, uint64_t salt, size_t buckets)
+    {
+        return reduce(mix(key ^ salt), buckets);
+    }
+
+    static constexpr size_t slotOf(uint64_t key, uint64_t salt, uint16_t seed, size_t slots)
+    {
+        return reduce(mix(mix(key + salt) ^ (seed + 1) * 0x9E3779B97F4A7C15ull), slots);
+    }
+
+    static constexpr uint32_t fingerprintOf(uint64_t key, uint64_t salt)
+    {
+        return static_cast<uint32_t>(mix(~key ^ salt) >> 32);
+    }
+
+    static constexpr uint16_t encode(Action best, double value)
+    {
+        const auto quantized = static_cast<uint32_t>(value * VALUE_SCALE + 0.5);
+        return static_cast<uint16_t>(quantized << 4 | static_cast<uint32_t>(best));
+    }
+
+    static constexpr Answer decode(uint16_t answer)
+    {
+        return {static_cast<Action>(answer & 0xF), static_cast<double>(answer >> 4) / VALUE_SCALE};
+    }
+};
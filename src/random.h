@@ -0,0 +1,181 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Philox4x32-10：基于计数器的随机数生成器（Salmon等，SC'11，Random123）。
+// 输出只由（种子，流编号，计数器）决定，没有内部状态链：
+// - 同一种子下不同流编号互相独立，可按局编号/任务编号分配，结果与线程数和调度顺序无关；
+// - 任意位置可O(1)跳转，批量填充与逐个抽取得到逐位相同的序列。
+class Philox4x32 {
+public:
+    using Block = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+    static constexpr Block generate(Block counter, Key key)
+    {
+        for (int round = 0; round < ROUNDS; ++round) {
+            const uint64_t product0 = static_cast<uint64_t>(MULTIPLIER_0) * counter[0];
+            const uint64_t product1 = static_cast<uint64_t>(MULTIPLIER_1) * counter[2];
+            counter = {static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                       static_cast<uint32_t>(product1),
+                       static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                       static_cast<uint32_t>(product0)};
+            key[0] += WEYL_0;
+            key[1] += WEYL_1;
+        }
+        return counter;
+    }
+
+private:
+    static constexpr int ROUNDS = 10;
+    static constexpr uint32_t MULTIPLIER_0 = 0xD2511F53;
+    static constexpr uint32_t MULTIPLIER_1 = 0xCD9E8D57;
+    static constexpr uint32_t WEYL_0 = 0x9E3779B9;
+    static constexpr uint32_t WEYL_1 = 0xBB67AE85;
+};
+
+// Random123的已知答案测试向量
+static_assert(Philox4x32::generate({0, 0, 0, 0}, {0, 0})
+              == Philox4x32::Block{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8});
+static_assert(Philox4x32::generate({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff})
+              == Philox4x32::Block{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd});
+
+// 基于Philox的随机数流，满足UniformRandomBitGenerator，可直接用于<random>的分布。
+// 计数器低64位为块序号，高64位为流编号；密钥为种子。
+class CounterRng {
+public:
+    using result_type = uint32_t;
+
+    explicit CounterRng(uint64_t seed = 0, uint64_t stream = 0)
+        : m_key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}
+        , m_stream(stream)
+    {
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    uint64_t seed() const { return m_key[0] | static_cast<uint64_t>(m_key[1]) << 32; }
+    uint64_t stream() const { return m_stream; }
+    uint64_t position() const { return m_position; } // 已消耗的32位输出个数
+
+    // 同一种子的另一条独立流
+    CounterRng withStream(uint64_t stream) const { return CounterRng(seed(), stream); }
+
+    // 跳到第position个32位输出，O(1)
+    void seek(uint64_t position)
+    {
+        m_position = position;
+        m_bufferedBlock = NO_BLOCK;
+    }
+    void discard(uint64_t count) { seek(m_position + count); }
+
+    result_type operator()()
+    {
+        const uint64_t blockIndex = m_position / 4;
+        if (blockIndex != m_bufferedBlock) {
+            m_buffer = block(blockIndex);
+            m_bufferedBlock = blockIndex;
+        }
+        return m_buffer[m_position++ % 4];
+    }
+
+    // [0,1)均匀分布，53位精度，每个值消耗两个32位输出
+    double uniform()
+    {
+        const uint32_t high = (*this)();
+        const uint32_t low = (*this)();
+        return toUnitDouble(high, low);
+    }
+
+    // [0,bound)内的均匀整数（Lemire无偏乘法拒绝法）
+    uint32_t below(uint32_t bound)
+    {
+        uint64_t product = static_cast<uint64_t>((*this)()) * bound;
+        auto low = static_cast<uint32_t>(product);
+        if (low < bound) {
+            const uint32_t threshold = static_cast<uint32_t>(-bound) % bound;
+            while (low < threshold) {
+                product = static_cast<uint64_t>((*this)()) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+    bool bernoulli(double probability) { return uniform() < probability; }
+
+    // 批量填充[0,1)均匀数，与逐个调用uniform()结果逐位相同；
+    // 对齐到块边界后按整块生成，内层循环没有分支，便于编译器向量化
+    void fillUniform(double *out, size_t count)
+    {
+        size_t i = 0;
+        while (i < count && m_position % 4 != 0) {
+            out[i++] = uniform();
+        }
+        const uint64_t firstBlock = m_position / 4;
+        uint64_t blockIndex = firstBlock;
+        for (; i + 2 <= count; i += 2, ++blockIndex) {
+            const Philox4x32::Block words = block(blockIndex);
+            out[i] = toUnitDouble(words[0], words[1]);
+            out[i + 1] = toUnitDouble(words[2], words[3]);
+        }
+        // 没有整块可生成时位置可能停在块中间，不能按块序号回写
+        if (blockIndex != firstBlock) {
+            m_position = blockIndex * 4;
+            m_bufferedBlock = NO_BLOCK;
+        }
+        if (i < count) {
+            out[i] = uniform();
+        }
+    }
+
+    void fillU32(uint32_t *out, size_t count)
+    {
+        size_t i = 0;
+        while (i < count && m_position % 4 != 0) {
+            out[i++] = (*this)();
+        }
+        const uint64_t firstBlock = m_position / 4;
+        uint64_t blockIndex = firstBlock;
+        for (; i + 4 <= count; i += 4, ++blockIndex) {
+            const Philox4x32::Block words = block(blockIndex);
+            out[i] = words[0];
+            out[i + 1] = words[1];
+            out[i + 2] = words[2];
+            out[i + 3] = words[3];
+        }
+        if (blockIndex != firstBlock) {
+            m_position = blockIndex * 4;
+            m_bufferedBlock = NO_BLOCK;
+        }
+        while (i < count) {
+            out[i++] = (*this)();
+        }
+    }
+
+private:
+    Philox4x32::Block block(uint64_t index) const
+    {
+        return Philox4x32::generate({static_cast<uint32_t>(index), static_cast<uint32_t>(index >> 32),
+                                     static_cast<uint32_t>(m_stream), static_cast<uint32_t>(m_stream >> 32)},
+                                    m_key);
+    }
+
+    static double toUnitDouble(uint32_t high, uint32_t low)
+    {
+        const uint64_t bits = (static_cast<uint64_t>(high) << 32 | low) >> 11;
+        return static_cast<double>(bits) * 0x1.0p-53;
+    }
+
+    static constexpr uint64_t NO_BLOCK = std::numeric_limits<uint64_t>::max();
+
+    Philox4x32::Key m_key;
+    uint64_t m_stream;
+    uint64_t m_position = 0;
+    uint64_t m_bufferedBlock = NO_BLOCK;
+    Philox4x32::Block m_buffer{};
+};
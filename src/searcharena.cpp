@@ -0,0 +1,87 @@
+#include "searcharena.h"
+#include <algorithm>
+#include <new>
+
+namespace {
+size_t alignUp(uintptr_t address, size_t alignment)
+{
+    return static_cast<size_t>((address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+}
+}
+
+SearchArena::SearchArena(size_t blockSize)
+    : m_blockSize(std::max<size_t>(blockSize, 4096))
+{
+}
+
+SearchArena::~SearchArena()
+{
+    release();
+}
+
+void SearchArena::reset()
+{
+    m_stats.highWaterBytes = std::max(m_stats.highWaterBytes, usedBytes());
+    m_current = m_first;
+    m_offset = 0;
+    m_usedBefore = 0;
+}
+
+void SearchArena::release()
+{
+    reset();
+    while (m_first) {
+        Block *next = m_first->next;
+        ::operator delete(m_first);
+        m_first = next;
+    }
+    m_current = nullptr;
+    m_stats.reservedBytes = 0;
+}
+
+size_t SearchArena::usedBytes() const
+{
+    return m_usedBefore + m_offset;
+}
+
+bool SearchArena::fitsCurrent(size_t bytes, size_t alignment) const
+{
+    if (!m_current) {
+        return false;
+    }
+    const uintptr_t base = reinterpret_cast<uintptr_t>(dataOf(m_current));
+    const size_t start = alignUp(base + m_offset, alignment) - base;
+    return start + bytes <= m_current->size;
+}
+
+void *SearchArena::do_allocate(size_t bytes, size_t alignment)
+{
+    ++m_stats.allocations;
+    m_stats.allocatedBytes += bytes;
+
+    if (!fitsCurrent(bytes, alignment)) {
+        // 先用reset后保留下来的块，不够大时才向系统申请，新块插在当前块之后
+        Block *next = m_current ? m_current->next : m_first;
+        const size_t needed = bytes + alignment;
+        if (!next || next->size < needed) {
+            const size_t size = std::max(m_blockSize, needed);
+            Block *block = static_cast<Block *>(::operator new(sizeof(Block) + size));
+            block->next = next;
+            block->size = size;
+            (m_current ? m_current->next : m_first) = block;
+            next = block;
+            ++m_stats.blockAllocations;
+            m_stats.reservedBytes += size;
+        }
+        if (m_current) {
+            m_usedBefore += m_offset;
+        }
+        m_current = next;
+        m_offset = 0;
+    }
+
+    const uintptr_t base = reinterpret_cast<uintptr_t>(dataOf(m_current));
+    const size_t start = alignUp(base + m_offset, alignment) - base;
+    m_offset = start + bytes;
+    return dataOf(m_current) + start;
+}
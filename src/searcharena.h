@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+// 搜索用的单调内存区：分配只移动指针，释放是空操作，reset()一次性收回本次查询的全部内存。
+// 内存块在reset后保留复用，热身后的查询不再向系统申请内存；每个Solver持有自己的内存区，
+// 各线程的Solver互不共享，因此不加锁。
+class SearchArena : public std::pmr::memory_resource {
+public:
+    struct Stats {
+        uint64_t allocations = 0;      // 经内存区完成的分配次数
+        uint64_t allocatedBytes = 0;
+        uint64_t blockAllocations = 0; // 向系统申请内存块的次数，热身后应不再增长
+        size_t reservedBytes = 0;      // 当前持有的内存块总大小
+        size_t highWaterBytes = 0;     // 单次查询的最大用量
+    };
+
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+
+    explicit SearchArena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+    ~SearchArena() override;
+    SearchArena(const SearchArena &) = delete;
+    SearchArena &operator=(const SearchArena &) = delete;
+
+    // 本次查询用量清零，内存块保留；调用前所有从内存区分配的对象必须已销毁
+    void reset();
+    // 把内存块全部还给系统
+    void release();
+
+    size_t usedBytes() const;
+    const Stats &stats() const { return m_stats; }
+
+private:
+    struct Block {
+        Block *next;
+        size_t size; // 不含块头
+    };
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *, size_t, size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+    static std::byte *dataOf(Block *block) { return reinterpret_cast<std::byte *>(block + 1); }
+    bool fitsCurrent(size_t bytes, size_t alignment) const;
+
+    size_t m_blockSize;
+    Block *m_first = nullptr;
+    Block *m_current = nullptr;
+    size_t m_offset = 0;     // 当前块内的已用字节
+    size_t m_usedBefore = 0; // 当前块之前各块的已用字节
+    Stats m_stats;
+};
@@ -0,0 +1,179 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "gamemodel.h"
+
+// 无道具的射击子博弈：剩余实弹、空包弹各不超过8发，双方血量不超过6，行动方手锯是否生效。
+// 局面很小且完全确定，编译期逆推求解成静态表；查询是一次下标访问，不做任何搜索。
+// 表以行动方视角存储，轮到庄家时交换双方血量并取补数。
+class ShotTable {
+public:
+    static constexpr int MAX_SHELLS_PER_TYPE = 8;
+    static constexpr int MAX_HEALTH = 6;
+    static constexpr size_t SIZE = 2 * (MAX_SHELLS_PER_TYPE + 1) * (MAX_SHELLS_PER_TYPE + 1)
+                                 * (MAX_HEALTH + 1) * (MAX_HEALTH + 1) * 2;
+
+    static constexpr bool contains(int live, int blank, int ownHealth, int opponentHealth)
+    {
+        return live >= 0 && blank >= 0 && live + blank > 0
+            && live <= MAX_SHELLS_PER_TYPE && blank <= MAX_SHELLS_PER_TYPE
+            && ownHealth >= 1 && ownHealth <= MAX_HEALTH && opponentHealth >= 1 && opponentHealth <= MAX_HEALTH;
+    }
+
+    // 行动方射击（action为两种射击之一）后的行动方胜率
+    static constexpr double actionValue(int live, int blank, int ownHealth, int opponentHealth, bool sawActive, Action action);
+    static constexpr double value(int live, int blank, int ownHealth, int opponentHealth, bool sawActive);
+
+    // 玩家视角：轮到谁行动，行动方采取action后玩家的胜率
+    static constexpr double playerWinProbability(int live, int blank, int playerHealth, int dealerHealth,
+                                                 bool playerTurn, bool sawActive, Action action)
+    {
+        return playerTurn ? actionValue(live, blank, playerHealth, dealerHealth, sawActive, action)
+                          : 1.0 - actionValue(live, blank, dealerHealth, playerHealth, sawActive, action);
+    }
+
+    static constexpr size_t index(int live, int blank, int ownHealth, int opponentHealth, bool sawActive, Action action)
+    {
+        return ((((static_cast<size_t>(sawActive) * (MAX_SHELLS_PER_TYPE + 1) + live) * (MAX_SHELLS_PER_TYPE + 1) + blank)
+                 * (MAX_HEALTH + 1) + ownHealth) * (MAX_HEALTH + 1) + opponentHealth) * 2
+             + (action == Action::ShootSelf ? 1 : 0);
+    }
+
+    // 逆推：按剩余子弹数从少到多，手锯生效的局面只依赖手锯未生效的后继
+    static constexpr std::array<double, SIZE> solve()
+    {
+        std::array<double, SIZE> table{};
+        auto stateValue = [&table](int live, int blank, int own, int opponent) {
+            const double atOpponent = table[index(live, blank, own, opponent, false, Action::ShootOpponent)];
+            const double atSelf = table[index(live, blank, own, opponent, false, Action::ShootSelf)];
+            return atOpponent > atSelf ? atOpponent : atSelf;
+        };
+        // 射出一发后的行动方胜率；keepsTurn为真时下一行动方仍是自己
+        auto after = [&](int live, int blank, int own, int opponent, bool keepsTurn) {
+            if (own <= 0) {
+                return 0.0;
+            }
+            if (opponent <= 0) {
+                return 1.0;
+            }
+            if (live + blank == 0) {
+                return GameRules::roundOverValue(own, opponent);
+            }
+            return keepsTurn ? stateValue(live, blank, own, opponent) : 1.0 - stateValue(live, blank, opponent, own);
+        };
+
+        for (int total = 1; total <= 2 * MAX_SHELLS_PER_TYPE; ++total) {
+            for (bool saw : {false, true}) {
+                const int damage = saw ? 2 : 1;
+                for (int live = 0; live <= total && live <= MAX_SHELLS_PER_TYPE; ++live) {
+                    const int blank = total - live;
+                    if (blank > MAX_SHELLS_PER_TYPE) {
+                        continue;
+                    }
+                    const double p = static_cast<double>(live) / total;
+                    for (int own = 1; own <= MAX_HEALTH; ++own) {
+                        for (int opponent = 1; opponent <= MAX_HEALTH; ++opponent) {
+                            double atOpponent = 0.0;
+                            double atSelf = 0.0;
+                            if (live > 0) {
+                                atOpponent += p * after(live - 1, blank, own, opponent - damage, false);
+                                atSelf += p * after(live - 1, blank, own - damage, opponent, false);
+                            }
+                            if (blank > 0) {
+                                atOpponent += (1 - p) * after(live, blank - 1, own, opponent, false);
+                                atSelf += (1 - p) * after(live, blank - 1, own, opponent, true);
+                            }
+                            table[index(live, blank, own, opponent, saw, Action::ShootOpponent)] = atOpponent;
+                            table[index(live, blank, own, opponent, saw, Action::ShootSelf)] = atSelf;
+                        }
+                    }
+                }
+            }
+        }
+        return table;
+    }
+
+    // 参考实现：直接按GameRules递归展开（与运行时Solver的规则相同），无记忆，只用于校验小局面
+    static constexpr double referenceActionValue(const Position &position, Action action)
+    {
+        Outcome outcomes[GameRules::MAX_OUTCOMES];
+        const int count = GameRules::outcomes(position, action, outcomes);
+        double value = 0.0;
+        for (int i = 0; i < count; ++i) {
+            const Outcome &outcome = outcomes[i];
+            double child = 0.0;
+            switch (outcome.result) {
+            case Outcome::Win:
+                child = 1.0;
+                break;
+            case Outcome::Loss:
+                child = 0.0;
+                break;
+            case Outcome::RoundOver:
+                child = GameRules::roundOverValue(outcome.next.health[0], outcome.next.health[1]);
+                break;
+            case Outcome::Continue: {
+                const double atOpponent = referenceActionValue(outcome.next, Action::ShootOpponent);
+                const double atSelf = referenceActionValue(outcome.next, Action::ShootSelf);
+                const double next = atOpponent > atSelf ? atOpponent : atSelf;
+                child = outcome.turnPassed ? 1.0 - next : next;
+                break;
+            }
+            }
+            value += outcome.probability * child;
+        }
+        return value;
+    }
+
+    // 与参考实现逐项比较：子弹合计不超过maxShells、血量不超过maxHealth的全部局面
+    static constexpr bool matchesReference(int maxShells, int maxHealth)
+    {
+        for (int live = 0; live <= maxShells; ++live) {
+            for (int blank = 0; live + blank <= maxShells; ++blank) {
+                for (int own = 1; own <= maxHealth; ++own) {
+                    for (int opponent = 1; opponent <= maxHealth; ++opponent) {
+                        for (bool saw : {false, true}) {
+                            if (live + blank == 0) {
+                                continue;
+                            }
+                            Position position;
+                            position.live = static_cast<uint8_t>(live);
+                            position.blank = static_cast<uint8_t>(blank);
+                            position.health = {static_cast<uint8_t>(own), static_cast<uint8_t>(opponent)};
+                            position.maxHealth = MAX_HEALTH;
+                            position.sawActive = saw;
+                            for (Action action : {Action::ShootOpponent, Action::ShootSelf}) {
+                                const double difference = actionValue(live, blank, own, opponent, saw, action)
+                                                        - referenceActionValue(position, action);
+                                if (difference > 1e-12 || difference < -1e-12) {
+                                    return false;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return true;
+    }
+};
+
+inline constexpr std::array<double, ShotTable::SIZE> SHOT_TABLE = ShotTable::solve();
+
+constexpr double ShotTable::actionValue(int live, int blank, int ownHealth, int opponentHealth, bool sawActive, Action action)
+{
+    return SHOT_TABLE[index(live, blank, ownHealth, opponentHealth, sawActive, action)];
+}
+
+constexpr double ShotTable::value(int live, int blank, int ownHealth, int opponentHealth, bool sawActive)
+{
+    const double atOpponent = actionValue(live, blank, ownHealth, opponentHealth, sawActive, Action::ShootOpponent);
+    const double atSelf = actionValue(live, blank, ownHealth, opponentHealth, sawActive, Action::ShootSelf);
+    return atOpponent > atSelf ? atOpponent : atSelf;
+}
+
+// 编译期与GameRules参考实现一致；最后一发必为实弹时的已知结论
+static_assert(ShotTable::matchesReference(4, 3));
+static_assert(ShotTable::actionValue(1, 0, 1, 1, false, Action::ShootOpponent) == 1.0);
+static_assert(ShotTable::actionValue(0, 1, 2, 2, false, Action::ShootSelf) == 0.5);
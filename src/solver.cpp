@@ -0,0 +1,90 @@
+#include "solver.h"
+#include <algorithm>
+
+Solver::Solver(TranspositionTable *shared)
+    : m_shared(shared)
+{
+    m_values.emplace(&m_arena);
+}
+
+Solver &Solver::forThisThread()
+{
+    thread_local Solver solver(&TranspositionTable::shared());
+    return solver;
+}
+
+Solver::Result Solver::solve(const Position &position)
+{
+    Result result{Action::ShootOpponent, -1.0};
+    for (int a = 0; a < ACTION_KINDS; ++a) {
+        const auto action = static_cast<Action>(a);
+        if (!GameRules::isLegal(position, action)) {
+            continue;
+        }
+        const double value = actionValue(position, action);
+        if (value > result.value) {
+            result = {action, value};
+        }
+    }
+    return result;
+}
+
+double Solver::value(const Position &position)
+{
+    const uint64_t key = position.key();
+    const auto cached = m_values->find(key);
+    if (cached != m_values->end()) {
+        return cached->second;
+    }
+    double value = 0.0;
+    if (m_shared && m_shared->probe(key, value)) {
+        ++m_sharedHits;
+    } else {
+        ++m_nodes;
+        value = solve(position).value;
+        if (m_shared) {
+            m_shared->store(key, value);
+        }
+    }
+    m_values->emplace(key, value);
+    return value;
+}
+
+double Solver::actionValue(const Position &position, Action action)
+{
+    Outcome outcomes[GameRules::MAX_OUTCOMES];
+    const int count = GameRules::outcomes(position, action, outcomes);
+    double value = 0.0;
+    for (int i = 0; i < count; ++i) {
+        const Outcome &outcome = outcomes[i];
+        double childValue = 0.0;
+        switch (outcome.result) {
+        case Outcome::Win:
+            childValue = 1.0;
+            break;
+        case Outcome::Loss:
+            childValue = 0.0;
+            break;
+        case Outcome::RoundOver:
+            childValue = GameRules::roundOverValue(outcome.next.health[0], outcome.next.health[1]);
+            break;
+        case Outcome::Continue:
+            childValue = outcome.turnPassed ? 1.0 - this->value(outcome.next) : this->value(outcome.next);
+            break;
+        }
+        value += outcome.probability * childValue;
+    }
+    return value;
+}
+
+void Solver::clear()
+{
+    // 哈希表销毁后才能收回内存区；按已见过的最大规模预留桶，之后的查询不再扩容
+    m_expectedPositions = std::max(m_expectedPositions, m_values->size());
+    m_values.reset();
+    m_arena.reset();
+    m_values.emplace(&m_arena);
+    m_values->reserve(m_expectedPositions);
+    m_nodes = 0;
+    m_sharedHits = 0;
+}
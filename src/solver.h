@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <unordered_map>
+#include "gamemodel.h"
+#include "searcharena.h"
+#include "transpositiontable.h"
+
+// 本地搜索引擎：对GameRules做期望极大极小搜索，双方都选择使自己胜率最高的行动，
+// 机会结局按概率加权。每个行动都消耗一发子弹或一件道具，搜索必然终止；
+// 子弹打完的局面用GameRules::roundOverValue估值。
+// 缓存的结点全部分配在Solver自己的SearchArena上，clear()一次性收回；热身后的查询不再申请堆内存。
+class Solver {
+public:
+    struct Result {
+        Action best = Action::ShootOpponent;
+        double value = 0.0; // 行动方胜率
+    };
+
+    explicit Solver(TranspositionTable *shared = nullptr);
+    // 当前线程的Solver：各线程的结点池互不共享，结果经TranspositionTable::shared()共享
+    static Solver &forThisThread();
+
+    // 本地缓存未命中时再查共享置换表，新结果同时写入；nullptr表示不共享
+    void share(TranspositionTable *table) { m_shared = table; }
+
+    // 根局面必须有子弹
+    Result solve(const Position &position);
+    double value(const Position &position);
+    // 行动方采取action后的胜率；多个线程可各自计算根局面的不同行动
+    double actionValue(const Position &position, Action action);
+
+    uint64_t nodes() const { return m_nodes; }
+    uint64_t sharedHits() const { return m_sharedHits; }
+    size_t cachedPositions() const { return m_values->size(); }
+    const SearchArena::Stats &memory() const { return m_arena.stats(); }
+    // 结束一次分析：缓存清空，内存块留给下一次查询
+    void clear();
+
+private:
+    using Memo = std::pmr::unordered_map<uint64_t, double>;
+
+    SearchArena m_arena; // 先于m_values构造、后于其析构
+    std::optional<Memo> m_values; // 键为Position::key()
+    size_t m_expectedPositions = 0;
+    TranspositionTable *m_shared = nullptr;
+    uint64_t m_nodes = 0;
+    uint64_t m_sharedHits = 0;
+};
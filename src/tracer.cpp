@@ -0,0 +1,147 @@
+#include "tracer.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Tracer::s_enabled{false};
+
+namespace {
+
+struct TraceEvent {
+    const char *name;
+    char phase;     // 'X' 完整区间, 'b'/'e' 异步开始/结束, 'i' 瞬时事件
+    qint64 timestamp;
+    qint64 duration;
+    quint64 id;
+};
+
+// 每个线程独占一个缓冲区；锁只在导出时才会出现竞争
+struct ThreadBuffer {
+    int threadIndex;
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+};
+
+const size_t MAX_EVENTS_PER_THREAD = 1 << 20;
+
+std::mutex g_registryMutex;
+std::vector<std::shared_ptr<ThreadBuffer>> g_registry;
+
+const std::chrono::steady_clock::time_point g_epoch = std::chrono::steady_clock::now();
+
+ThreadBuffer &threadBuffer()
+{
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+        auto created = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(g_registryMutex);
+        created->threadIndex = static_cast<int>(g_registry.size());
+        created->events.reserve(4096);
+        g_registry.push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+
+void record(const TraceEvent &event)
+{
+    ThreadBuffer &buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    if (buffer.events.size() < MAX_EVENTS_PER_THREAD) {
+        buffer.events.push_back(event);
+    }
+}
+
+} // namespace
+
+void Tracer::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+qint64 Tracer::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - g_epoch).count();
+}
+
+void Tracer::recordComplete(const char *name, qint64 startNs, qint64 endNs)
+{
+    record({name, 'X', startNs, endNs - startNs, 0});
+}
+
+void Tracer::recordAsyncBegin(const char *name, quint64 id)
+{
+    record({name, 'b', now(), 0, id});
+}
+
+void Tracer::recordAsyncEnd(const char *name, quint64 id)
+{
+    record({name, 'e', now(), 0, id});
+}
+
+void Tracer::recordInstant(const char *name)
+{
+    record({name, 'i', now(), 0, 0});
+}
+
+bool Tracer::exportChromeTrace(const QString &filePath)
+{
+    QJsonArray traceEvents;
+
+    std::lock_guard<std::mutex> registryLock(g_registryMutex);
+    for (const auto &buffer : g_registry) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+
+        QJsonObject threadName;
+        threadName["name"] = "thread_name";
+        threadName["ph"] = "M";
+        threadName["pid"] = 1;
+        threadName["tid"] = buffer->threadIndex;
+        threadName["args"] = QJsonObject{{"name", buffer->threadIndex == 0 ? QString("main")
+                                                                            : QString("thread-%1").arg(buffer->threadIndex)}};
+        traceEvents.append(threadName);
+
+        for (const auto &event : buffer->events) {
+            QJsonObject obj;
+            obj["name"] = QString::fromUtf8(event.name);
+            obj["ph"] = QString(QChar(event.phase));
+            obj["pid"] = 1;
+            obj["tid"] = buffer->threadIndex;
+            obj["ts"] = event.timestamp / 1000.0; // trace-event格式以微秒为单位
+            if (event.phase == 'X') {
+                obj["dur"] = event.duration / 1000.0;
+            } else if (event.phase == 'b' || event.phase == 'e') {
+                obj["cat"] = "async";
+                obj["id"] = QString::number(event.id);
+            } else if (event.phase == 'i') {
+                obj["s"] = "t";
+            }
+            traceEvents.append(obj);
+        }
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return true;
+}
+
+void Tracer::clear()
+{
+    std::lock_guard<std::mutex> registryLock(g_registryMutex);
+    for (const auto &buffer : g_registry) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        buffer->events.clear();
+    }
+}
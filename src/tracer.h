@@ -0,0 +1,69 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+// 设为0时所有TRACE_*宏展开为空，完全不产生代码
+#ifndef BRT_ENABLE_TRACING
+#define BRT_ENABLE_TRACING 1
+#endif
+
+// 轻量级耗时追踪：事件记录在各线程自己的缓冲区中，可导出为Chrome trace-event JSON，
+// 在 chrome://tracing 或 Perfetto 中查看。未启用时每个追踪点只有一次原子读取
+class Tracer {
+public:
+    static void setEnabled(bool enabled);
+    static bool isEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+    static qint64 now(); // 纳秒，单调时钟
+
+    static void recordComplete(const char *name, qint64 startNs, qint64 endNs);
+    static void recordAsyncBegin(const char *name, quint64 id);
+    static void recordAsyncEnd(const char *name, quint64 id);
+    static void recordInstant(const char *name);
+
+    static bool exportChromeTrace(const QString &filePath);
+    static void clear();
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+// 作用域耗时区间，析构时记录一个完整事件（"X"）
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *name)
+        : m_name(name)
+        , m_start(Tracer::isEnabled() ? Tracer::now() : -1)
+    {
+    }
+
+    ~TraceSpan()
+    {
+        if (m_start >= 0) {
+            Tracer::recordComplete(m_name, m_start, Tracer::now());
+        }
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+private:
+    const char *m_name;
+    qint64 m_start;
+};
+
+#if BRT_ENABLE_TRACING
+#define BRT_TRACE_CONCAT_IMPL(a, b) a##b
+#define BRT_TRACE_CONCAT(a, b) BRT_TRACE_CONCAT_IMPL(a, b)
+#define TRACE_SCOPE(name) TraceSpan BRT_TRACE_CONCAT(traceSpan_, __LINE__)(name)
+#define TRACE_ASYNC_BEGIN(name, id) do { if (Tracer::isEnabled()) Tracer::recordAsyncBegin(name, id); } while (0)
+#define TRACE_ASYNC_END(name, id) do { if (Tracer::isEnabled()) Tracer::recordAsyncEnd(name, id); } while (0)
+#define TRACE_INSTANT(name) do { if (Tracer::isEnabled()) Tracer::recordInstant(name); } while (0)
+#else
+#define TRACE_SCOPE(name) do {} while (0)
+#define TRACE_ASYNC_BEGIN(name, id) do {} while (0)
+#define TRACE_ASYNC_END(name, id) do {} while (0)
+#define TRACE_INSTANT(name) do {} while (0)
+#endif
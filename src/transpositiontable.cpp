@@ -0,0 +1,36 @@
+#include "transpositiontable.h"
+#include <algorithm>
+
+TranspositionTable::TranspositionTable(size_t entries)
+{
+    const size_t capacity = std::bit_ceil(std::max<size_t>(entries, 2));
+    m_shift = 64 - std::countr_zero(capacity);
+    m_entries = std::make_unique<Entry[]>(capacity);
+}
+
+void TranspositionTable::clear()
+{
+    for (size_t i = 0; i < capacity(); ++i) {
+        m_entries[i].check.store(0, std::memory_order_relaxed);
+        m_entries[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+double TranspositionTable::occupancy() const
+{
+    const size_t step = std::max<size_t>(1, capacity() / 65536);
+    size_t sampled = 0;
+    size_t used = 0;
+    for (size_t i = 0; i < capacity(); i += step) {
+        ++sampled;
+        used += m_entries[i].check.load(std::memory_order_relaxed) != 0
+             || m_entries[i].data.load(std::memory_order_relaxed) != 0;
+    }
+    return static_cast<double>(used) / sampled;
+}
+
+TranspositionTable &TranspositionTable::shared()
+{
+    static TranspositionTable table;
+    return table;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// 多个搜索线程共享的置换表：固定大小，不加锁，新结果直接覆盖旧结果（有损）。
+// 每项是两个原子字：data为胜率的位模式，check为key ^ data。读写各自原子但不成对，
+// 被并发写撕裂的项校验不通过，当作未命中。局面的胜率只由局面决定，命中的结果与自己计算的逐位相同。
+// 空项两字皆为0，会被当作key 0的结果；有子弹的局面key不为0，不会误中。
+class TranspositionTable {
+public:
+    static constexpr size_t DEFAULT_ENTRIES = size_t(1) << 20; // 16 MiB
+
+    // 项数向上取2的幂
+    explicit TranspositionTable(size_t entries = DEFAULT_ENTRIES);
+
+    bool probe(uint64_t key, double &value) const
+    {
+        const Entry &entry = m_entries[indexOf(key)];
+        const uint64_t check = entry.check.load(std::memory_order_relaxed);
+        const uint64_t data = entry.data.load(std::memory_order_relaxed);
+        if ((check ^ data) != key) {
+            return false;
+        }
+        value = std::bit_cast<double>(data);
+        return true;
+    }
+
+    void store(uint64_t key, double value)
+    {
+        Entry &entry = m_entries[indexOf(key)];
+        const uint64_t data = std::bit_cast<uint64_t>(value);
+        entry.data.store(data, std::memory_order_relaxed);
+        entry.check.store(key ^ data, std::memory_order_relaxed);
+    }
+
+    // 不能与probe/store并发调用
+    void clear();
+    size_t capacity() const { return size_t(1) << (64 - m_shift); }
+    // 已占用项的比例，按抽样估计
+    double occupancy() const;
+
+    // 进程内的搜索线程共用的表，首次使用时分配
+    static TranspositionTable &shared();
+
+private:
+    struct alignas(16) Entry {
+        std::atomic<uint64_t> check{0};
+        std::atomic<uint64_t> data{0};
+    };
+
+    // 乘法哈希取高位
+    size_t indexOf(uint64_t key) const { return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> m_shift); }
+
+    std::unique_ptr<Entry[]> m_entries;
+    int m_shift;
+};
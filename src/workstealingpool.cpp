@@ -0,0 +1,144 @@
+#include "workstealingpool.h"
+#include <algorithm>
+
+namespace {
+// 线程当前所在的池和编号；外部线程进入run()时临时设置，离开时恢复
+thread_local const WorkStealingPool *t_pool = nullptr;
+thread_local int t_participant = -1;
+}
+
+WorkStealingPool::WorkStealingPool(int participants)
+{
+    if (participants <= 0) {
+        participants = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    for (int i = 0; i < participants; ++i) {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+    for (int i = 1; i < participants; ++i) {
+        m_threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (std::thread &thread : m_threads) {
+        thread.join();
+    }
+}
+
+int WorkStealingPool::currentParticipant() const
+{
+    return t_pool == this ? t_participant : -1;
+}
+
+void WorkStealingPool::enter()
+{
+    t_pool = this;
+    t_participant = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_active = true;
+    }
+    m_activeFlag.store(true, std::memory_order_release);
+    m_wake.notify_all();
+}
+
+void WorkStealingPool::leave()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_active = false;
+    }
+    m_activeFlag.store(false, std::memory_order_release);
+    t_pool = nullptr;
+    t_participant = -1;
+}
+
+void WorkStealingPool::spawn(Group &group, Task task)
+{
+    Queue &queue = *m_queues[currentParticipant()];
+    group.pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.bottom - queue.top < QUEUE_CAPACITY) {
+            queue.ring[queue.bottom++ % QUEUE_CAPACITY] = {task, &group};
+            return;
+        }
+    }
+    execute({task, &group});
+}
+
+void WorkStealingPool::wait(Group &group)
+{
+    const int self = currentParticipant();
+    while (group.pending.load(std::memory_order_acquire) > 0) {
+        if (!tryRunOne(self)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void WorkStealingPool::execute(const Entry &entry)
+{
+    entry.task.run(entry.task.context);
+    entry.group->pending.fetch_sub(1, std::memory_order_release);
+}
+
+bool WorkStealingPool::takeTask(int self, Entry &entry)
+{
+    {
+        Queue &own = *m_queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.bottom > own.top) {
+            entry = own.ring[--own.bottom % QUEUE_CAPACITY];
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < m_queues.size(); ++offset) {
+        Queue &victim = *m_queues[(self + offset) % m_queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.bottom > victim.top) {
+            entry = victim.ring[victim.top++ % QUEUE_CAPACITY];
+            m_steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WorkStealingPool::tryRunOne(int self)
+{
+    Entry entry{};
+    if (!takeTask(self, entry)) {
+        return false;
+    }
+    execute(entry);
+    return true;
+}
+
+void WorkStealingPool::workerLoop(int index)
+{
+    t_pool = this;
+    t_participant = index;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_stateMutex);
+            m_wake.wait(lock, [this]() { return m_active || m_stopping; });
+            if (m_stopping) {
+                return;
+            }
+        }
+        // run()期间不停地找活干，结束后回到休眠
+        while (m_activeFlag.load(std::memory_order_acquire)) {
+            if (!tryRunOne(index)) {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取线程池：每个参与者有自己的任务队列，从队尾压入、弹出（后进先出，局部性好），
+// 空闲的参与者从别人的队首窃取（先进先出，偷到的通常是较大的子树）。
+// 调用run()的线程作为0号参与者一起干活，后台线程只在run()期间取任务，其余时间休眠。
+// 等待一组任务时不阻塞，而是继续执行队列里的任务，因此任务内可以再派生任务并等待。
+// 任务是函数指针加上下文指针，派生和执行都不分配内存。
+class WorkStealingPool {
+public:
+    struct Task {
+        void (*run)(void *context);
+        void *context;
+    };
+
+    // 一组派生的任务，wait()等到全部完成
+    struct Group {
+        std::atomic<int> pending{0};
+    };
+
+    // participants为参与者总数（含调用run()的线程），0表示硬件线程数
+    explicit WorkStealingPool(int participants = 0);
+    ~WorkStealingPool();
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    // 以0号参与者身份执行body；同一时刻只有一个外部线程进入
+    template <typename F>
+    void run(F &&body)
+    {
+        std::lock_guard<std::mutex> caller(m_callerMutex);
+        enter();
+        body();
+        leave();
+    }
+
+    // 只能在参与者线程上调用；队列满时直接在当前线程执行
+    void spawn(Group &group, Task task);
+    void wait(Group &group);
+
+    int participants() const { return static_cast<int>(m_queues.size()); }
+    // 当前线程在本池中的编号，不是参与者时为-1
+    int currentParticipant() const;
+    uint64_t steals() const { return m_steals.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr size_t QUEUE_CAPACITY = 4096;
+
+    struct Entry {
+        Task task;
+        Group *group;
+    };
+
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::array<Entry, QUEUE_CAPACITY> ring;
+        size_t top = 0;    // 窃取端
+        size_t bottom = 0; // 所有者端
+    };
+
+    void enter();
+    void leave();
+    void workerLoop(int index);
+    // 先取自己队尾的任务，没有再从其他参与者队首窃取
+    bool takeTask(int self, Entry &entry);
+    bool tryRunOne(int self);
+    static void execute(const Entry &entry);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+    std::mutex m_callerMutex;
+    std::mutex m_stateMutex;
+    std::condition_variable m_wake;
+    bool m_active = false;
+    bool m_stopping = false;
+    std::atomic<bool> m_activeFlag{false};
+    std::atomic<uint64_t> m_steals{0};
+};
@@ -0,0 +1,177 @@
+#include "aiclient.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QLoggingCategory>
+#include <QTextStream>
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+
+// 用多个AIClient并发请求指定端点（通常是MockAIServer），统计延迟分布
+namespace {
+struct Sample {
+    qint64 totalMs;
+    qint64 firstTokenMs; // 非流式或未收到增量时为-1
+    int attempts;
+    bool ok;
+};
+
+qint64 percentile(QList<qint64> values, double p)
+{
+    if (values.isEmpty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    int index = qBound(0, static_cast<int>(values.size() * p / 100.0), static_cast<int>(values.size()) - 1);
+    return values[index];
+}
+
+void printDistribution(QTextStream &out, const char *name, const QList<qint64> &values)
+{
+    if (values.isEmpty()) {
+        return;
+    }
+    qint64 sum = 0;
+    for (qint64 value : values) {
+        sum += value;
+    }
+    out << QString("%1  n=%2  min=%3  mean=%4  p50=%5  p90=%6  p99=%7  max=%8 (ms)\n")
+               .arg(name, -12).arg(values.size())
+               .arg(*std::min_element(values.begin(), values.end()))
+               .arg(sum / values.size())
+               .arg(percentile(values, 50)).arg(percentile(values, 90)).arg(percentile(values, 99))
+               .arg(*std::max_element(values.begin(), values.end()));
+}
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("AIClientHarness");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("驱动AIClient压测OpenAI兼容端点并输出延迟分布");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"url", "API地址", "url", "http://127.0.0.1:8080/v1/chat/completions"},
+        {"key", "API Key", "key", "mock"},
+        {"model", "模型名", "model", "mock-model"},
+        {"requests", "请求总数", "count", "50"},
+        {"concurrency", "并发客户端数", "count", "4"},
+        {"retries", "每个请求的最大重试次数", "count", "3"},
+        {"rpm", "每分钟请求上限，0为不限", "count", "0"},
+        {"stream", "使用流式输出"},
+        {"verbose", "输出AIClient的调试日志"},
+    });
+    parser.process(app);
+
+    if (!parser.isSet("verbose")) {
+        QLoggingCategory::setFilterRules("ai.debug=false");
+    }
+
+    const int totalRequests = qMax(1, parser.value("requests").toInt());
+    const int concurrency = qBound(1, parser.value("concurrency").toInt(), totalRequests);
+    const bool streaming = parser.isSet("stream");
+    AIClient::setRequestsPerMinute(parser.value("rpm").toInt());
+
+    const QString systemPrompt = "你是Buckshot Roulette博弈分析师。";
+    const QString userPrompt = "L2 B3 P3/4 D2/4 N1\nPI 放大镜 手锯";
+
+    QList<Sample> samples;
+    int issued = 0;
+    QElapsedTimer wallClock;
+    wallClock.start();
+
+    // 每个客户端串行发送，收到结果后立即发下一个
+    for (int i = 0; i < concurrency; ++i) {
+        AIClient *client = new AIClient(&app);
+        client->setApiUrl(parser.value("url"));
+        client->setApiKey(parser.value("key"));
+        client->setModel(parser.value("model"));
+        client->setStreaming(streaming);
+        client->setMaxRetries(parser.value("retries").toInt());
+
+        auto timer = std::make_shared<QElapsedTimer>();
+        auto firstToken = std::make_shared<qint64>(-1);
+        auto attempts = std::make_shared<int>(0);
+        auto done = std::make_shared<bool>(false);
+
+        auto sendNext = [&, client, timer, firstToken, attempts, done]() {
+            if (issued >= totalRequests) {
+                return;
+            }
+            ++issued;
+            *firstToken = -1;
+            *attempts = 0;
+            *done = false;
+            timer->start();
+            client->sendRequest(systemPrompt, userPrompt);
+        };
+
+        auto onDelta = [timer, firstToken]() {
+            if (*firstToken < 0) {
+                *firstToken = timer->elapsed();
+            }
+        };
+        QObject::connect(client, &AIClient::partialResponse, client, onDelta);
+        QObject::connect(client, &AIClient::partialReasoning, client, onDelta);
+        QObject::connect(client, &AIClient::attemptFinished, client, [attempts](int attempt) {
+            *attempts = attempt;
+        });
+
+        auto record = [&, timer, firstToken, attempts, done](bool ok) {
+            if (*done) {
+                return; // 超时等路径可能先报错再结束，只记录一次
+            }
+            *done = true;
+            samples.append({timer->elapsed(), *firstToken, *attempts, ok});
+        };
+        QObject::connect(client, &AIClient::responseReceived, client, [record]() { record(true); });
+        QObject::connect(client, &AIClient::errorOccurred, client, [record](const QString &error) {
+            fprintf(stderr, "error: %s\n", qPrintable(error));
+            record(false);
+        });
+        QObject::connect(client, &AIClient::requestFinished, client, [&, sendNext]() {
+            if (samples.size() >= totalRequests) {
+                app.quit();
+            } else {
+                // 等requestFinished返回后再发，避免在AIClient清理当前请求的过程中重入
+                QMetaObject::invokeMethod(client, sendNext, Qt::QueuedConnection);
+            }
+        });
+
+        QMetaObject::invokeMethod(client, sendNext, Qt::QueuedConnection);
+    }
+
+    app.exec();
+
+    QList<qint64> totals, firstTokens, attemptCounts;
+    int failures = 0;
+    for (const Sample &sample : samples) {
+        if (!sample.ok) {
+            ++failures;
+            continue;
+        }
+        totals.append(sample.totalMs);
+        if (sample.firstTokenMs >= 0) {
+            firstTokens.append(sample.firstTokenMs);
+        }
+        attemptCounts.append(sample.attempts);
+    }
+
+    QTextStream out(stdout);
+    const double seconds = wallClock.elapsed() / 1000.0;
+    out << QString("requests=%1  ok=%2  failed=%3  concurrency=%4  stream=%5  wall=%6s  throughput=%7 req/s\n")
+               .arg(samples.size()).arg(totals.size()).arg(failures).arg(concurrency)
+               .arg(streaming ? "yes" : "no").arg(seconds, 0, 'f', 2)
+               .arg(samples.size() / qMax(0.001, seconds), 0, 'f', 2);
+    printDistribution(out, "total", totals);
+    printDistribution(out, "first-token", firstTokens);
+    if (!attemptCounts.isEmpty()) {
+        qint64 retried = std::count_if(attemptCounts.begin(), attemptCounts.end(), [](qint64 n) { return n > 1; });
+        out << QString("retried      %1 of %2 successful requests needed more than one attempt\n")
+                   .arg(retried).arg(attemptCounts.size());
+    }
+    return failures > 0 ? 1 : 0;
+}
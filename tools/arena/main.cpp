@@ -0,0 +1,343 @@
+#include "gamemodel.h"
+#include "policies.h"
+#include "random.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 策略竞技场：各策略作为玩家与同一庄家策略对战大量带种子的完整对局。
+// 第g局的装弹、道具和机会事件只由（种子，g）决定，结果与线程数无关；
+// 各策略在同一局中面对相同的装弹序列，两两对比使用配对差值。
+namespace {
+struct Config {
+    uint64_t games = 1000000;
+    int threads = 0;
+    uint64_t seed = 1;
+    int items = 0; // 每次装弹每方获得的道具数
+    const PolicyInfo *dealer = nullptr;
+    std::vector<const PolicyInfo *> policies;
+};
+
+struct GameResult {
+    bool won;
+    int shots;
+    int loads;
+};
+
+struct Stats {
+    uint64_t wins = 0;
+    uint64_t shots = 0;
+    uint64_t loads = 0;
+    uint64_t nanoseconds = 0;
+};
+
+constexpr uint64_t CHUNK_GAMES = 4096;
+constexpr uint64_t DRAWS_PER_LOAD = 64; // 每次装弹预留的随机数，保证第k次装弹与之前的消耗无关
+constexpr int MAX_LOADS = 64;           // 双方一直不掉血时的保护
+
+// 装弹：2~8发，实弹与空包弹各至少1发，随机排列
+void load(Position &position, uint32_t &chamber, CounterRng &dealRng, int loadIndex, int items)
+{
+    dealRng.seek(static_cast<uint64_t>(loadIndex + 1) * DRAWS_PER_LOAD);
+    const int total = 2 + static_cast<int>(dealRng.below(Position::MAX_SHELLS - 1));
+    const int live = 1 + static_cast<int>(dealRng.below(total - 1));
+
+    // 选择抽样：逐位以 剩余实弹/剩余位置 的概率放入实弹
+    chamber = 0;
+    int remainingLive = live;
+    for (int offset = 0; offset < total; ++offset) {
+        if (static_cast<int>(dealRng.below(total - offset)) < remainingLive) {
+            chamber |= 1u << offset;
+            --remainingLive;
+        }
+    }
+
+    position.live = static_cast<uint8_t>(live);
+    position.blank = static_cast<uint8_t>(total - live);
+    position.knownMask = 0;
+    position.liveMask = 0;
+    position.sawActive = false;
+    position.opponentCuffed = false;
+    for (int side = 0; side < 2; ++side) {
+        for (int i = 0; i < items; ++i) {
+            uint8_t &count = position.items[side][dealRng.below(ITEM_KINDS)];
+            count = std::min<uint8_t>(count + 1, Position::MAX_ITEM_COUNT);
+        }
+    }
+}
+
+// 在模型列出的结局中找出与真实弹膛一致的那个
+const Outcome &resolve(const Outcome *outcomes, int count, const Position &position, Action action,
+                       uint32_t chamber, CounterRng &chanceRng)
+{
+    if (count == 1) {
+        return outcomes[0];
+    }
+    if (action == useItem(Item::ExpiredMedicine)) {
+        const bool healed = chanceRng.bernoulli(0.5);
+        return *std::find_if(outcomes, outcomes + count, [healed](const Outcome &o) { return o.medicineHealed == healed; });
+    }
+    if (action == useItem(Item::BurnerPhone)) {
+        const int offset = 1 + static_cast<int>(chanceRng.below(position.shells() - 1));
+        const bool isLive = chamber >> offset & 1;
+        return *std::find_if(outcomes, outcomes + count, [offset, isLive](const Outcome &o) {
+            return o.revealed == offset && o.shellLive == isLive;
+        });
+    }
+    const bool isLive = chamber & 1;
+    return *std::find_if(outcomes, outcomes + count, [isLive](const Outcome &o) { return o.shellLive == isLive; });
+}
+
+GameResult playGame(const PolicyInfo &player, const PolicyInfo &dealer, uint64_t seed, uint64_t game, int items)
+{
+    CounterRng dealRng(seed, game * 3);
+    CounterRng policyRng(seed, game * 3 + 1);
+    CounterRng chanceRng(seed, game * 3 + 2);
+
+    Position position;
+    position.maxHealth = static_cast<uint8_t>(2 + dealRng.below(5));
+    position.health = {position.maxHealth, position.maxHealth};
+
+    GameResult result{false, 0, 1};
+    uint32_t chamber = 0;
+    bool playerToMove = true; // 每次装弹后玩家先手
+    load(position, chamber, dealRng, 0, items);
+
+    Outcome outcomes[GameRules::MAX_OUTCOMES];
+    for (;;) {
+        const PolicyInfo &actor = playerToMove ? player : dealer;
+        Action action = actor.choose(position, policyRng);
+        if (!GameRules::isLegal(position, action)) {
+            action = Action::ShootOpponent;
+        }
+
+        const int count = GameRules::outcomes(position, action, outcomes);
+        const Outcome &outcome = resolve(outcomes, count, position, action, chamber, chanceRng);
+        if (!isItemAction(action)) {
+            ++result.shots;
+        }
+        if (!isItemAction(action) || action == useItem(Item::Beer)) {
+            chamber >>= 1;
+        } else if (action == useItem(Item::Inverter)) {
+            chamber ^= 1;
+        }
+
+        switch (outcome.result) {
+        case Outcome::Win:
+            result.won = playerToMove;
+            return result;
+        case Outcome::Loss:
+            result.won = !playerToMove;
+            return result;
+        case Outcome::RoundOver:
+            position = playerToMove ? outcome.next : outcome.next.flipped();
+            playerToMove = true;
+            if (result.loads >= MAX_LOADS) {
+                result.won = position.health[0] > position.health[1];
+                return result;
+            }
+            load(position, chamber, dealRng, result.loads++, items);
+            break;
+        case Outcome::Continue:
+            position = outcome.next;
+            if (outcome.turnPassed) {
+                playerToMove = !playerToMove;
+            }
+            break;
+        }
+    }
+}
+
+// Wilson得分区间，95%
+void wilsonInterval(uint64_t successes, uint64_t trials, double &low, double &high)
+{
+    const double z = 1.96;
+    const double n = static_cast<double>(trials);
+    const double p = successes / n;
+    const double denominator = 1.0 + z * z / n;
+    const double center = (p + z * z / (2 * n)) / denominator;
+    const double half = z * std::sqrt(p * (1 - p) / n + z * z / (4 * n * n)) / denominator;
+    low = center - half;
+    high = center + half;
+}
+
+void printUsage()
+{
+    std::printf("usage: PolicyArena [--games N] [--threads N] [--seed N] [--items N]\n"
+                "                   [--dealer NAME] [--policies a,b,c] [--list]\n");
+}
+
+bool parseArguments(int argc, char *argv[], Config &config)
+{
+    std::string policyList = "threshold,ev,random";
+    std::string dealerName = "dealer";
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (std::strcmp(arg, "--list") == 0) {
+            for (const PolicyInfo &policy : Policies::registered()) {
+                std::printf("%-10s %s\n", policy.name, policy.description);
+            }
+            std::exit(0);
+        }
+        if (!value) {
+            printUsage();
+            return false;
+        }
+        if (std::strcmp(arg, "--games") == 0) {
+            config.games = std::max<uint64_t>(1, std::strtoull(value, nullptr, 10));
+        } else if (std::strcmp(arg, "--threads") == 0) {
+            config.threads = std::atoi(value);
+        } else if (std::strcmp(arg, "--seed") == 0) {
+            config.seed = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(arg, "--items") == 0) {
+            config.items = std::clamp(std::atoi(value), 0, 8);
+        } else if (std::strcmp(arg, "--dealer") == 0) {
+            dealerName = value;
+        } else if (std::strcmp(arg, "--policies") == 0) {
+            policyList = value;
+        } else {
+            printUsage();
+            return false;
+        }
+        ++i;
+    }
+
+    config.dealer = Policies::find(dealerName);
+    if (!config.dealer) {
+        std::fprintf(stderr, "unknown dealer policy: %s\n", dealerName.c_str());
+        return false;
+    }
+    size_t start = 0;
+    while (start <= policyList.size()) {
+        const size_t end = std::min(policyList.find(',', start), policyList.size());
+        const std::string name = policyList.substr(start, end - start);
+        const PolicyInfo *policy = Policies::find(name);
+        if (!policy) {
+            std::fprintf(stderr, "unknown policy: %s\n", name.c_str());
+            return false;
+        }
+        config.policies.push_back(policy);
+        start = end + 1;
+    }
+    if (config.threads <= 0) {
+        config.threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    return true;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    Config config;
+    if (!parseArguments(argc, argv, config)) {
+        return 2;
+    }
+
+    const size_t policyCount = config.policies.size();
+    std::vector<Stats> stats(policyCount);
+    // discordant[a * n + b]：同一局中a赢而b输的局数
+    std::vector<uint64_t> discordant(policyCount * policyCount);
+    std::mutex mergeMutex;
+    std::atomic<uint64_t> nextChunk{0};
+
+    const auto wallStart = std::chrono::steady_clock::now();
+    auto worker = [&]() {
+        std::vector<Stats> localStats(policyCount);
+        std::vector<uint64_t> localDiscordant(policyCount * policyCount);
+        std::vector<bool> won(policyCount);
+        for (;;) {
+            const uint64_t first = nextChunk.fetch_add(1, std::memory_order_relaxed) * CHUNK_GAMES;
+            if (first >= config.games) {
+                break;
+            }
+            const uint64_t last = std::min(first + CHUNK_GAMES, config.games);
+            for (uint64_t game = first; game < last; ++game) {
+                for (size_t p = 0; p < policyCount; ++p) {
+                    const auto start = std::chrono::steady_clock::now();
+                    const GameResult result = playGame(*config.policies[p], *config.dealer, config.seed, game, config.items);
+                    localStats[p].nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        std::chrono::steady_clock::now() - start).count();
+                    localStats[p].wins += result.won;
+                    localStats[p].shots += result.shots;
+                    localStats[p].loads += result.loads;
+                    won[p] = result.won;
+                }
+                for (size_t a = 0; a < policyCount; ++a) {
+                    for (size_t b = 0; b < policyCount; ++b) {
+                        localDiscordant[a * policyCount + b] += won[a] && !won[b];
+                    }
+                }
+            }
+        }
+
+        std::lock_guard lock(mergeMutex);
+        for (size_t p = 0; p < policyCount; ++p) {
+            stats[p].wins += localStats[p].wins;
+            stats[p].shots += localStats[p].shots;
+            stats[p].loads += localStats[p].loads;
+            stats[p].nanoseconds += localStats[p].nanoseconds;
+        }
+        for (size_t i = 0; i < discordant.size(); ++i) {
+            discordant[i] += localDiscordant[i];
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < config.threads; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    const double games = static_cast<double>(config.games);
+    std::printf("games=%llu  policies=%zu  dealer=%s  items=%d  threads=%d  seed=%llu  wall=%.2fs  throughput=%.0f games/s\n",
+                static_cast<unsigned long long>(config.games), policyCount, config.dealer->name, config.items,
+                config.threads, static_cast<unsigned long long>(config.seed), wallSeconds,
+                games * policyCount / std::max(1e-9, wallSeconds));
+    std::printf("%-10s %8s %19s %8s %7s %14s\n", "policy", "win", "95% CI", "shots", "loads", "games/s/core");
+    for (size_t p = 0; p < policyCount; ++p) {
+        double low = 0;
+        double high = 0;
+        wilsonInterval(stats[p].wins, config.games, low, high);
+        std::printf("%-10s %7.2f%% [%6.2f%%, %6.2f%%] %8.2f %7.2f %14.0f\n", config.policies[p]->name,
+                    100.0 * stats[p].wins / games, 100 * low, 100 * high,
+                    stats[p].shots / games, stats[p].loads / games,
+                    games / std::max(1e-9, stats[p].nanoseconds / 1e9));
+    }
+
+    // 配对差值：每局 d = 行胜 - 列胜，均值与95%区间
+    if (policyCount > 1) {
+        std::printf("\nhead-to-head (row win rate - column win rate, same games, 95%% CI):\n%-10s", "");
+        for (size_t b = 0; b < policyCount; ++b) {
+            std::printf(" %17s", config.policies[b]->name);
+        }
+        std::printf("\n");
+        for (size_t a = 0; a < policyCount; ++a) {
+            std::printf("%-10s", config.policies[a]->name);
+            for (size_t b = 0; b < policyCount; ++b) {
+                if (a == b) {
+                    std::printf(" %17s", "-");
+                    continue;
+                }
+                const double ahead = discordant[a * policyCount + b] / games;
+                const double behind = discordant[b * policyCount + a] / games;
+                const double mean = ahead - behind;
+                const double variance = std::max(0.0, ahead + behind - mean * mean);
+                std::printf(" %+8.2f%% ±%5.2f%%", 100 * mean, 100 * 1.96 * std::sqrt(variance / games));
+            }
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+#include "batchkernels.h"
+#include "random.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// 比较三种路径每秒处理的局面数：
+// per-call  逐个局面、每项结果各自重新计算实弹概率（DecisionHelper原有写法）
+// scalar    批量核函数的标量实现
+// avx2      批量核函数的AVX2实现（CPU支持时）
+namespace {
+struct LegacyState {
+    int live;
+    int blank;
+    int knownLiveAhead;
+    int knownBlankAhead;
+    int current;
+    int opponentHealth;
+    int ownHealth;
+    bool handsaw;
+};
+
+double legacyLiveProbability(const LegacyState &state)
+{
+    int total = state.live + state.blank;
+    if (total <= 0) {
+        return 0.0;
+    }
+    if (state.current >= 0) {
+        return state.current;
+    }
+    int unknownTotal = total - state.knownLiveAhead - state.knownBlankAhead;
+    return unknownTotal > 0 ? static_cast<double>(state.live - state.knownLiveAhead) / unknownTotal
+                            : (state.live > 0 ? 1.0 : 0.0);
+}
+
+double legacyShootOpponent(const LegacyState &state)
+{
+    double p = legacyLiveProbability(state);
+    return p * (state.handsaw ? 2.0 : 1.0) - (1.0 - p) * 0.1;
+}
+
+double legacyShootSelf(const LegacyState &state)
+{
+    double p = legacyLiveProbability(state);
+    return (1.0 - p) - p * 2.0;
+}
+
+double legacyKill(const LegacyState &state, int health)
+{
+    return health <= (state.handsaw ? 2 : 1) ? legacyLiveProbability(state) : 0.0;
+}
+
+struct Columns {
+    std::vector<double> live, blank, knownLiveAhead, knownBlankAhead, current, opponentHealth, ownHealth, damage;
+    std::vector<double> liveProbability, opponentKill, selfKill, shootOpponent, shootSelf;
+
+    explicit Columns(size_t count)
+        : live(count), blank(count), knownLiveAhead(count), knownBlankAhead(count), current(count)
+        , opponentHealth(count), ownHealth(count), damage(count)
+        , liveProbability(count), opponentKill(count), selfKill(count), shootOpponent(count), shootSelf(count)
+    {
+    }
+
+    ShellBatch input() const
+    {
+        return {live.size(), live.data(), blank.data(), knownLiveAhead.data(), knownBlankAhead.data(),
+                current.data(), opponentHealth.data(), ownHealth.data(), damage.data()};
+    }
+
+    ShotBatch output()
+    {
+        return {liveProbability.data(), opponentKill.data(), selfKill.data(), shootOpponent.data(), shootSelf.data()};
+    }
+};
+
+template <typename F>
+double statesPerSecond(size_t states, int repetitions, F &&run)
+{
+    run(); // 预热
+    const auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r) {
+        run();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return states * static_cast<double>(repetitions) / std::max(1e-9, seconds);
+}
+}
+
+int main(int argc, char *argv[])
+{
+    // 默认批量能放进L2缓存；更大的批量受内存带宽限制
+    size_t count = 4096;
+    int repetitions = 5000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--states") == 0) {
+            count = std::max<size_t>(1, std::strtoull(argv[i + 1], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--repetitions") == 0) {
+            repetitions = std::max(1, std::atoi(argv[i + 1]));
+        }
+    }
+
+    // 随机但合法的局面：已知子弹不超过剩余数量
+    CounterRng rng(2024);
+    std::vector<LegacyState> states(count);
+    Columns columns(count);
+    for (size_t i = 0; i < count; ++i) {
+        LegacyState &s = states[i];
+        s.live = static_cast<int>(rng.below(5));
+        s.blank = static_cast<int>(rng.below(5));
+        s.knownLiveAhead = s.live > 1 ? static_cast<int>(rng.below(s.live)) : 0;
+        s.knownBlankAhead = s.blank > 1 ? static_cast<int>(rng.below(s.blank)) : 0;
+        s.current = rng.below(4) == 0 && s.live + s.blank > 0 ? (s.live > 0 && rng.below(2) ? 1 : (s.blank > 0 ? 0 : 1)) : -1;
+        s.opponentHealth = 1 + static_cast<int>(rng.below(6));
+        s.ownHealth = 1 + static_cast<int>(rng.below(6));
+        s.handsaw = rng.below(4) == 0;
+
+        columns.live[i] = s.live;
+        columns.blank[i] = s.blank;
+        columns.knownLiveAhead[i] = s.knownLiveAhead;
+        columns.knownBlankAhead[i] = s.knownBlankAhead;
+        columns.current[i] = s.current;
+        columns.opponentHealth[i] = s.opponentHealth;
+        columns.ownHealth[i] = s.ownHealth;
+        columns.damage[i] = s.handsaw ? 2 : 1;
+    }
+
+    std::vector<double> legacyOut(count * 5);
+    const double legacyRate = statesPerSecond(count, repetitions, [&]() {
+        for (size_t i = 0; i < count; ++i) {
+            legacyOut[i * 5] = legacyLiveProbability(states[i]);
+            legacyOut[i * 5 + 1] = legacyKill(states[i], states[i].opponentHealth);
+            legacyOut[i * 5 + 2] = legacyKill(states[i], states[i].ownHealth);
+            legacyOut[i * 5 + 3] = legacyShootOpponent(states[i]);
+            legacyOut[i * 5 + 4] = legacyShootSelf(states[i]);
+        }
+    });
+
+    const ShellBatch input = columns.input();
+    const ShotBatch output = columns.output();
+    const double scalarRate = statesPerSecond(count, repetitions, [&]() {
+        BatchKernels::evaluate(input, output, BatchKernels::Isa::Scalar);
+    });
+    const std::vector<double> scalarValues = columns.shootOpponent;
+    const std::vector<double> scalarProbabilities = columns.liveProbability;
+
+    // 标量与逐个计算的结果必须一致
+    for (size_t i = 0; i < count; ++i) {
+        if (legacyOut[i * 5] != scalarProbabilities[i] || legacyOut[i * 5 + 3] != scalarValues[i]) {
+            std::fprintf(stderr, "scalar kernel differs from per-call path at state %zu\n", i);
+            return 1;
+        }
+    }
+
+    std::printf("states=%zu  repetitions=%d  dispatch=%s\n", count, repetitions,
+                BatchKernels::isaName(BatchKernels::bestIsa()));
+    std::printf("per-call  %12.0f states/s\n", legacyRate);
+    std::printf("scalar    %12.0f states/s  x%.2f\n", scalarRate, scalarRate / legacyRate);
+
+    if (BatchKernels::supports(BatchKernels::Isa::Avx2)) {
+        const double avx2Rate = statesPerSecond(count, repetitions, [&]() {
+            BatchKernels::evaluate(input, output, BatchKernels::Isa::Avx2);
+        });
+        const bool identical = std::memcmp(scalarValues.data(), columns.shootOpponent.data(), count * sizeof(double)) == 0
+                            && std::memcmp(scalarProbabilities.data(), columns.liveProbability.data(), count * sizeof(double)) == 0;
+        std::printf("avx2      %12.0f states/s  x%.2f  (vs scalar x%.2f, %s)\n", avx2Rate, avx2Rate / legacyRate,
+                    avx2Rate / scalarRate, identical ? "bit-identical" : "MISMATCH");
+        if (!identical) {
+            return 1;
+        }
+    } else {
+        std::printf("avx2      not supported on this CPU\n");
+    }
+    return 0;
+}
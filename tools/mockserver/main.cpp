@@ -0,0 +1,54 @@
+#include "mockserver.h"
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDebug>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("MockAIServer");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("本地模拟的OpenAI兼容接口，监听 http://127.0.0.1:<port>/v1/chat/completions");
+    parser.addHelpOption();
+    parser.addOptions({
+        {"port", "监听端口", "port", "8080"},
+        {"latency", "首字节延迟（毫秒）", "ms", "300"},
+        {"jitter", "首字节延迟的随机抖动上限（毫秒）", "ms", "100"},
+        {"token-rate", "每秒生成的token数", "tokens", "50"},
+        {"tokens", "每次回答的正文token数", "count", "120"},
+        {"reasoning", "每次回答的reasoning_content token数", "count", "0"},
+        {"fault-rate", "随机注入错误的概率（0~1）", "rate", "0"},
+        {"faults", "注入的错误类型，逗号分隔：401,429,500,malformed,truncate", "list", ""},
+        {"retry-after", "429响应的Retry-After秒数", "seconds", "1"},
+        {"api-key", "非空时要求请求携带该Bearer令牌", "key", ""},
+    });
+    parser.process(app);
+
+    MockServer::Options options;
+    options.latencyMs = parser.value("latency").toInt();
+    options.jitterMs = parser.value("jitter").toInt();
+    options.tokensPerSecond = parser.value("token-rate").toDouble();
+    options.contentTokens = parser.value("tokens").toInt();
+    options.reasoningTokens = parser.value("reasoning").toInt();
+    options.faultRate = parser.value("fault-rate").toDouble();
+    options.retryAfterSeconds = parser.value("retry-after").toInt();
+    options.apiKey = parser.value("api-key");
+    for (const QString &name : parser.value("faults").split(',', Qt::SkipEmptyParts)) {
+        MockServer::Fault fault = MockServer::parseFault(name);
+        if (fault == MockServer::Fault::None) {
+            qCritical().noquote() << "未知的错误类型:" << name;
+            return 1;
+        }
+        options.faults.append(fault);
+    }
+
+    MockServer server(options);
+    if (!server.listen(static_cast<quint16>(parser.value("port").toUInt()))) {
+        qCritical().noquote() << "无法监听端口" << parser.value("port");
+        return 1;
+    }
+    qInfo().noquote() << QString("Mock server listening on http://127.0.0.1:%1/v1/chat/completions").arg(server.port());
+
+    return app.exec();
+}
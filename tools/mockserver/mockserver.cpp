@@ -0,0 +1,348 @@
+#include "mockserver.h"
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QSharedPointer>
+#include <QDebug>
+
+namespace {
+const QString CANNED_CONTENT = QStringLiteral(
+    "建议先使用放大镜查看当前子弹。若为实弹，先用手锯再射击庄家；若为空包弹，射击自己以保留回合。"
+    "剩余实弹概率较高时优先使用道具获取信息，血量劣势时避免射击自己。");
+const QString CANNED_REASONING = QStringLiteral(
+    "当前剩余子弹中实弹占比决定了射击自己的风险，结合双方血量和道具计算两种行动的期望收益。");
+
+const char *statusText(int status)
+{
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    case 429: return "Too Many Requests";
+    case 500: return "Internal Server Error";
+    default: return "Unknown";
+    }
+}
+
+QByteArray sseEvent(const QJsonObject &obj)
+{
+    return "data: " + QJsonDocument(obj).toJson(QJsonDocument::Compact) + "\n\n";
+}
+
+void writeChunk(QTcpSocket *socket, const QByteArray &data)
+{
+    socket->write(QByteArray::number(data.size(), 16) + "\r\n" + data + "\r\n");
+}
+}
+
+MockServer::MockServer(const Options &options, QObject *parent)
+    : QObject(parent)
+    , m_server(new QTcpServer(this))
+    , m_options(options)
+    , m_requestCount(0)
+{
+    if (m_options.faults.isEmpty()) {
+        m_options.faults = {Fault::Unauthorized, Fault::RateLimited, Fault::ServerError,
+                            Fault::MalformedJson, Fault::TruncatedStream};
+    }
+    connect(m_server, &QTcpServer::newConnection, this, &MockServer::onNewConnection);
+}
+
+bool MockServer::listen(quint16 port)
+{
+    return m_server->listen(QHostAddress::LocalHost, port);
+}
+
+quint16 MockServer::port() const
+{
+    return m_server->serverPort();
+}
+
+MockServer::Fault MockServer::parseFault(const QString &name)
+{
+    const QString key = name.trimmed().toLower();
+    if (key == "401" || key == "unauthorized") return Fault::Unauthorized;
+    if (key == "429" || key == "ratelimit") return Fault::RateLimited;
+    if (key == "500" || key == "server") return Fault::ServerError;
+    if (key == "malformed") return Fault::MalformedJson;
+    if (key == "truncate") return Fault::TruncatedStream;
+    return Fault::None;
+}
+
+void MockServer::onNewConnection()
+{
+    while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+        m_buffers.insert(socket, QByteArray());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { handleSocketData(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_buffers.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+void MockServer::handleSocketData(QTcpSocket *socket)
+{
+    m_buffers[socket] += socket->readAll();
+
+    // 同一连接上一个响应未完成前不处理下一个请求
+    if (socket->property("busy").toBool()) {
+        return;
+    }
+
+    QByteArray &buffer = m_buffers[socket];
+    int headerEnd = buffer.indexOf("\r\n\r\n");
+    if (headerEnd < 0) {
+        return;
+    }
+
+    Request request;
+    const QList<QByteArray> lines = buffer.left(headerEnd).split('\n');
+    const QList<QByteArray> requestLine = lines.value(0).trimmed().split(' ');
+    request.method = requestLine.value(0);
+    request.path = requestLine.value(1);
+    for (int i = 1; i < lines.size(); ++i) {
+        int colon = lines[i].indexOf(':');
+        if (colon > 0) {
+            request.headers.insert(lines[i].left(colon).trimmed().toLower(), lines[i].mid(colon + 1).trimmed());
+        }
+    }
+
+    int contentLength = request.headers.value("content-length").toInt();
+    if (buffer.size() < headerEnd + 4 + contentLength) {
+        return; // 正文尚未收全
+    }
+    request.body = buffer.mid(headerEnd + 4, contentLength);
+    buffer.remove(0, headerEnd + 4 + contentLength);
+
+    socket->setProperty("busy", true);
+    handleRequest(socket, request);
+}
+
+void MockServer::finishResponse(QTcpSocket *socket)
+{
+    socket->setProperty("busy", false);
+    if (m_buffers.value(socket).contains("\r\n\r\n")) {
+        handleSocketData(socket);
+    }
+}
+
+void MockServer::handleRequest(QTcpSocket *socket, const Request &request)
+{
+    ++m_requestCount;
+
+    if (request.method != "POST" || !request.path.endsWith("/chat/completions")) {
+        sendError(socket, 404, "not_found", "Unknown endpoint");
+        return;
+    }
+
+    Fault fault = pickFault(request);
+
+    QByteArray expectedAuth = "Bearer " + m_options.apiKey.toUtf8();
+    if (fault == Fault::Unauthorized
+        || (!m_options.apiKey.isEmpty() && request.headers.value("authorization") != expectedAuth)) {
+        sendError(socket, 401, "invalid_request_error", "Incorrect API key provided");
+        return;
+    }
+
+    QJsonParseError parseError;
+    QJsonDocument doc = QJsonDocument::fromJson(request.body, &parseError);
+    if (parseError.error != QJsonParseError::NoError || !doc.object()["messages"].isArray()) {
+        sendError(socket, 400, "invalid_request_error", "Request body must be a JSON object with messages");
+        return;
+    }
+    const QJsonObject requestObj = doc.object();
+
+    // 错误响应同样经过首字节延迟，更接近真实服务
+    QTimer::singleShot(firstByteDelayMs(), socket, [this, socket, requestObj, fault]() {
+        if (fault == Fault::RateLimited) {
+            QJsonObject error{{"message", "Rate limit reached for requests"}, {"type", "rate_limit_exceeded"}};
+            sendResponse(socket, 429, "application/json",
+                         QJsonDocument(QJsonObject{{"error", error}}).toJson(QJsonDocument::Compact),
+                         {{"Retry-After", QByteArray::number(m_options.retryAfterSeconds)}});
+        } else if (fault == Fault::ServerError) {
+            sendError(socket, 500, "server_error", "The server had an error while processing your request");
+        } else if (requestObj["stream"].toBool()) {
+            startStream(socket, requestObj, fault);
+        } else {
+            // 非流式：等待全部token生成完毕后一次性返回
+            int generationMs = static_cast<int>((m_options.reasoningTokens + m_options.contentTokens)
+                                                * 1000.0 / qMax(1.0, m_options.tokensPerSecond));
+            QTimer::singleShot(generationMs, socket, [this, socket, requestObj, fault]() {
+                sendCompletion(socket, requestObj, fault);
+            });
+        }
+    });
+}
+
+MockServer::Fault MockServer::pickFault(const Request &request) const
+{
+    // 请求头X-Mock-Fault可为单个请求指定错误，便于定向测试
+    QByteArray forced = request.headers.value("x-mock-fault");
+    if (!forced.isEmpty()) {
+        return parseFault(QString::fromLatin1(forced));
+    }
+    if (m_options.faultRate > 0 && QRandomGenerator::global()->generateDouble() < m_options.faultRate) {
+        return m_options.faults[QRandomGenerator::global()->bounded(m_options.faults.size())];
+    }
+    return Fault::None;
+}
+
+int MockServer::firstByteDelayMs() const
+{
+    return m_options.latencyMs + (m_options.jitterMs > 0 ? QRandomGenerator::global()->bounded(m_options.jitterMs + 1) : 0);
+}
+
+void MockServer::sendResponse(QTcpSocket *socket, int status, const QByteArray &contentType, const QByteArray &body,
+                              const QList<QPair<QByteArray, QByteArray>> &extraHeaders)
+{
+    QByteArray response = "HTTP/1.1 " + QByteArray::number(status) + ' ' + statusText(status) + "\r\n";
+    response += "Content-Type: " + contentType + "\r\n";
+    response += "Content-Length: " + QByteArray::number(body.size()) + "\r\n";
+    response += "Connection: keep-alive\r\n";
+    for (const auto &header : extraHeaders) {
+        response += header.first + ": " + header.second + "\r\n";
+    }
+    response += "\r\n" + body;
+    socket->write(response);
+
+    qInfo().noquote() << QString("#%1 -> %2 (%3 bytes)").arg(m_requestCount).arg(status).arg(body.size());
+    finishResponse(socket);
+}
+
+void MockServer::sendError(QTcpSocket *socket, int status, const QString &type, const QString &message)
+{
+    QJsonObject error{{"message", message}, {"type", type}};
+    sendResponse(socket, status, "application/json",
+                 QJsonDocument(QJsonObject{{"error", error}}).toJson(QJsonDocument::Compact));
+}
+
+void MockServer::sendCompletion(QTcpSocket *socket, const QJsonObject &requestObj, Fault fault)
+{
+    if (fault == Fault::MalformedJson) {
+        sendResponse(socket, 200, "application/json", "{\"choices\": [{\"message\": {\"content\": ");
+        return;
+    }
+
+    QString content;
+    for (int i = 0; i < m_options.contentTokens; ++i) {
+        content += tokenText(i);
+    }
+    QJsonObject message{{"role", "assistant"}, {"content", content}};
+    if (m_options.reasoningTokens > 0) {
+        QString reasoning;
+        for (int i = 0; i < m_options.reasoningTokens; ++i) {
+            reasoning += CANNED_REASONING.at(i % CANNED_REASONING.size());
+        }
+        message["reasoning_content"] = reasoning;
+    }
+
+    QJsonObject choice{{"index", 0}, {"message", message}, {"finish_reason", "stop"}};
+    QJsonObject response{
+        {"id", QString("chatcmpl-mock-%1").arg(m_requestCount)},
+        {"object", "chat.completion"},
+        {"created", QDateTime::currentSecsSinceEpoch()},
+        {"model", requestObj["model"].toString()},
+        {"choices", QJsonArray{choice}},
+        {"usage", usageObject(estimatePromptTokens(requestObj))}
+    };
+    QByteArray body = QJsonDocument(response).toJson(QJsonDocument::Compact);
+    if (fault == Fault::TruncatedStream) {
+        body.truncate(body.size() / 2);
+    }
+    sendResponse(socket, 200, "application/json", body);
+}
+
+void MockServer::startStream(QTcpSocket *socket, const QJsonObject &requestObj, Fault fault)
+{
+    socket->write("HTTP/1.1 200 OK\r\n"
+                  "Content-Type: text/event-stream\r\n"
+                  "Cache-Control: no-cache\r\n"
+                  "Transfer-Encoding: chunked\r\n"
+                  "Connection: keep-alive\r\n\r\n");
+
+    if (fault == Fault::MalformedJson) {
+        writeChunk(socket, "data: {\"choices\": [{\"delta\": \n\n");
+    }
+
+    const int totalTokens = m_options.reasoningTokens + m_options.contentTokens;
+    const int stopAt = fault == Fault::TruncatedStream ? totalTokens / 2 : totalTokens;
+    const QString id = QString("chatcmpl-mock-%1").arg(m_requestCount);
+    const QString model = requestObj["model"].toString();
+    const bool includeUsage = requestObj["stream_options"].toObject()["include_usage"].toBool();
+    const int promptTokens = estimatePromptTokens(requestObj);
+    const quint64 requestNumber = m_requestCount;
+
+    auto makeChunk = [id, model](const QJsonObject &delta, const QJsonValue &finishReason) {
+        QJsonObject choice{{"index", 0}, {"delta", delta}, {"finish_reason", finishReason}};
+        return QJsonObject{{"id", id}, {"object", "chat.completion.chunk"},
+                           {"created", QDateTime::currentSecsSinceEpoch()},
+                           {"model", model}, {"choices", QJsonArray{choice}}};
+    };
+
+    QTimer *timer = new QTimer(socket);
+    timer->setInterval(qMax(1, static_cast<int>(1000.0 / qMax(1.0, m_options.tokensPerSecond))));
+    QSharedPointer<int> sent(new int(0));
+
+    connect(timer, &QTimer::timeout, socket, [=, this]() {
+        if (*sent >= stopAt) {
+            timer->stop();
+            timer->deleteLater();
+            if (fault == Fault::TruncatedStream) {
+                // 不发送结束块直接断开，模拟中途掉线
+                qInfo().noquote() << QString("#%1 -> 200 stream truncated after %2 tokens").arg(requestNumber).arg(*sent);
+                socket->abort();
+                return;
+            }
+            writeChunk(socket, sseEvent(makeChunk(QJsonObject(), "stop")));
+            if (includeUsage) {
+                QJsonObject usageChunk{{"id", id}, {"object", "chat.completion.chunk"}, {"model", model},
+                                       {"choices", QJsonArray()}, {"usage", usageObject(promptTokens)}};
+                writeChunk(socket, sseEvent(usageChunk));
+            }
+            writeChunk(socket, "data: [DONE]\n\n");
+            socket->write("0\r\n\r\n");
+            qInfo().noquote() << QString("#%1 -> 200 stream (%2 tokens)").arg(requestNumber).arg(*sent);
+            finishResponse(socket);
+            return;
+        }
+
+        QJsonObject delta;
+        if (*sent == 0) {
+            delta["role"] = "assistant";
+        }
+        if (*sent < m_options.reasoningTokens) {
+            delta["reasoning_content"] = QString(CANNED_REASONING.at(*sent % CANNED_REASONING.size()));
+        } else {
+            delta["content"] = tokenText(*sent - m_options.reasoningTokens);
+        }
+        writeChunk(socket, sseEvent(makeChunk(delta, QJsonValue::Null)));
+        ++*sent;
+    });
+    timer->start();
+}
+
+QJsonObject MockServer::usageObject(int promptTokens) const
+{
+    const int completionTokens = m_options.reasoningTokens + m_options.contentTokens;
+    return QJsonObject{{"prompt_tokens", promptTokens},
+                       {"completion_tokens", completionTokens},
+                       {"total_tokens", promptTokens + completionTokens}};
+}
+
+QString MockServer::tokenText(int index)
+{
+    return CANNED_CONTENT.at(index % CANNED_CONTENT.size());
+}
+
+int MockServer::estimatePromptTokens(const QJsonObject &requestObj)
+{
+    // 与真实分词无关，只需随提示词长度单调变化
+    int chars = 0;
+    for (const QJsonValue &message : requestObj["messages"].toArray()) {
+        chars += message.toObject()["content"].toString().size();
+    }
+    return chars + 4 * requestObj["messages"].toArray().size();
+}
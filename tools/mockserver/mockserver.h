@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QObject>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QJsonObject>
+#include <QHash>
+
+// 本地模拟的OpenAI兼容 /v1/chat/completions 服务，用于AIClient的延迟与压力测试
+class MockServer : public QObject {
+    Q_OBJECT
+
+public:
+    // 可注入的错误类型
+    enum class Fault {
+        None,
+        Unauthorized,   // 401
+        RateLimited,    // 429，附带Retry-After
+        ServerError,    // 500
+        MalformedJson,  // 200但正文不是合法JSON
+        TruncatedStream // 流式输出到一半断开连接（非流式请求时正文截断）
+    };
+
+    struct Options {
+        int latencyMs = 300;          // 首字节延迟
+        int jitterMs = 100;           // 首字节延迟的随机抖动上限
+        double tokensPerSecond = 50;  // 生成速度，非流式请求按此计算总耗时
+        int contentTokens = 120;      // 每次回答的token数
+        int reasoningTokens = 0;      // 大于0时先输出reasoning_content
+        double faultRate = 0.0;       // 随机注入错误的概率
+        QList<Fault> faults;          // 随机注入时从中选取
+        int retryAfterSeconds = 1;
+        QString apiKey;               // 非空时校验Bearer令牌
+    };
+
+    explicit MockServer(const Options &options, QObject *parent = nullptr);
+
+    bool listen(quint16 port);
+    quint16 port() const;
+
+    static Fault parseFault(const QString &name);
+
+private slots:
+    void onNewConnection();
+
+private:
+    struct Request {
+        QByteArray method;
+        QByteArray path;
+        QHash<QByteArray, QByteArray> headers; // 名称统一为小写
+        QByteArray body;
+    };
+
+    void handleSocketData(QTcpSocket *socket);
+    void finishResponse(QTcpSocket *socket);
+    void handleRequest(QTcpSocket *socket, const Request &request);
+    Fault pickFault(const Request &request) const;
+    int firstByteDelayMs() const;
+
+    void sendResponse(QTcpSocket *socket, int status, const QByteArray &contentType, const QByteArray &body,
+                      const QList<QPair<QByteArray, QByteArray>> &extraHeaders = {});
+    void sendError(QTcpSocket *socket, int status, const QString &type, const QString &message);
+    void sendCompletion(QTcpSocket *socket, const QJsonObject &requestObj, Fault fault);
+    void startStream(QTcpSocket *socket, const QJsonObject &requestObj, Fault fault);
+
+    QJsonObject usageObject(int promptTokens) const;
+    static QString tokenText(int index);
+    static int estimatePromptTokens(const QJsonObject &requestObj);
+
+    QTcpServer *m_server;
+    Options m_options;
+    QHash<QTcpSocket *, QByteArray> m_buffers; // 每个连接尚未处理的请求数据
+    quint64 m_requestCount;
+};
@@ -0,0 +1,232 @@
+#include "gamemodel.h"
+#include "policytable.h"
+#include "random.h"
+#include "solver.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 求解常见局面，构建最小完美哈希，生成编译进程序的policytable.inc：
+// xmake run PolicyTableGen --output src/policytable.inc
+// 常见局面：血量上限2/4/6、双方存活、实弹与空包弹都有且合计不超过8发、当前子弹未知、
+// 行动方至多持有一件道具、对手无道具。
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct Entry {
+    uint64_t key;
+    uint16_t answer;
+};
+
+struct Table {
+    uint64_t salt = 0;
+    std::vector<uint16_t> seeds;
+    std::vector<uint32_t> fingerprints;
+    std::vector<uint16_t> answers;
+
+    PolicyTable::Layout layout() const { return {salt, seeds, fingerprints, answers}; }
+};
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::vector<Position> commonPositions()
+{
+    std::vector<Position> positions;
+    for (int maxHealth : {2, 4, 6}) {
+        for (int own = 1; own <= maxHealth; ++own) {
+            for (int opponent = 1; opponent <= maxHealth; ++opponent) {
+                for (int live = 1; live < Position::MAX_SHELLS; ++live) {
+                    for (int blank = 1; live + blank <= Position::MAX_SHELLS; ++blank) {
+                        for (int item = -1; item < ITEM_KINDS; ++item) {
+                            Position position;
+                            position.live = static_cast<uint8_t>(live);
+                            position.blank = static_cast<uint8_t>(blank);
+                            position.maxHealth = static_cast<uint8_t>(maxHealth);
+                            position.health = {static_cast<uint8_t>(own), static_cast<uint8_t>(opponent)};
+                            if (item >= 0) {
+                                position.items[0][item] = 1;
+                            }
+                            positions.push_back(position);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return positions;
+}
+
+// 哈希-位移：键先分桶，从大桶开始为每个桶寻找能把全部键放进空槽的种子
+bool buildTable(const std::vector<Entry> &entries, uint64_t salt, double keysPerBucket, Table &table)
+{
+    const size_t slots = entries.size();
+    const size_t bucketCount = std::max<size_t>(1, static_cast<size_t>(slots / keysPerBucket));
+    std::vector<std::vector<const Entry *>> buckets(bucketCount);
+    for (const Entry &entry : entries) {
+        buckets[PolicyTable::bucketOf(entry.key, salt, bucketCount)].push_back(&entry);
+    }
+    std::vector<size_t> order(bucketCount);
+    for (size_t i = 0; i < bucketCount; ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+    table.salt = salt;
+    table.seeds.assign(bucketCount, 0);
+    table.fingerprints.assign(slots, 0);
+    table.answers.assign(slots, 0);
+    std::vector<bool> taken(slots, false);
+    std::vector<size_t> candidate;
+
+    for (size_t bucket : order) {
+        const auto &keys = buckets[bucket];
+        if (keys.empty()) {
+            break;
+        }
+        bool placed = false;
+        for (uint32_t seed = 0; seed <= UINT16_MAX && !placed; ++seed) {
+            candidate.clear();
+            placed = true;
+            for (const Entry *entry : keys) {
+                const size_t slot = PolicyTable::slotOf(entry->key, salt, static_cast<uint16_t>(seed), slots);
+                if (taken[slot] || std::find(candidate.begin(), candidate.end(), slot) != candidate.end()) {
+                    placed = false;
+                    break;
+                }
+                candidate.push_back(slot);
+            }
+            if (placed) {
+                table.seeds[bucket] = static_cast<uint16_t>(seed);
+                for (size_t i = 0; i < keys.size(); ++i) {
+                    taken[candidate[i]] = true;
+                    table.fingerprints[candidate[i]] = PolicyTable::fingerprintOf(keys[i]->key, salt);
+                    table.answers[candidate[i]] = keys[i]->answer;
+                }
+            }
+        }
+        if (!placed) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+void writeArray(FILE *file, const char *type, const char *name, const std::vector<T> &values, const char *format, int perLine)
+{
+    std::fprintf(file, "constexpr %s %s[] = {", type, name);
+    for (size_t i = 0; i < values.size(); ++i) {
+        std::fprintf(file, i % perLine == 0 ? "\n    " : " ");
+        std::fprintf(file, format, values[i]);
+        std::fprintf(file, ",");
+    }
+    std::fprintf(file, "\n};\n");
+}
+
+bool writeTable(const char *path, const Table &table, size_t positions)
+{
+    FILE *file = std::fopen(path, "w");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "// 由PolicyTableGen生成，请勿手工修改\n");
+    std::fprintf(file, "// positions=%zu  buckets=%zu  bytes=%zu\n\n", positions, table.seeds.size(),
+                 PolicyTable::sizeBytes(table.layout()));
+    std::fprintf(file, "constexpr uint64_t POLICY_TABLE_SALT = 0x%016llxull;\n",
+                 static_cast<unsigned long long>(table.salt));
+    writeArray(file, "uint16_t", "POLICY_TABLE_SEEDS", table.seeds, "%u", 16);
+    writeArray(file, "uint32_t", "POLICY_TABLE_FINGERPRINTS", table.fingerprints, "0x%08x", 8);
+    writeArray(file, "uint16_t", "POLICY_TABLE_ANSWERS", table.answers, "0x%04x", 12);
+    return std::fclose(file) == 0;
+}
+}
+
+int main(int argc, char *argv[])
+{
+    const char *output = "src/policytable.inc";
+    double keysPerBucket = 4.0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--output") == 0) {
+            output = argv[i + 1];
+        } else if (std::strcmp(argv[i], "--keys-per-bucket") == 0) {
+            keysPerBucket = std::max(1.0, std::atof(argv[i + 1]));
+        }
+    }
+
+    // 求解
+    const auto solveStart = Clock::now();
+    const std::vector<Position> positions = commonPositions();
+    Solver solver;
+    std::vector<Entry> entries;
+    entries.reserve(positions.size());
+    for (const Position &position : positions) {
+        const Solver::Result result = solver.solve(position);
+        entries.push_back({position.key(), PolicyTable::encode(result.best, result.value)});
+    }
+    const double solveSeconds = secondsSince(solveStart);
+
+    // 构建完美哈希，失败时换盐重试
+    const auto buildStart = Clock::now();
+    Table table;
+    uint64_t salt = 0x42;
+    int attempts = 1;
+    while (!buildTable(entries, PolicyTable::mix(salt), keysPerBucket, table)) {
+        ++salt;
+        ++attempts;
+    }
+    const double buildSeconds = secondsSince(buildStart);
+
+    // 校验：收录的键全部命中且答案一致，随机键被指纹拒绝
+    const PolicyTable::Layout layout = table.layout();
+    for (const Entry &entry : entries) {
+        const auto answer = PolicyTable::probe(layout, entry.key);
+        if (!answer || PolicyTable::encode(answer->best, answer->value) != entry.answer) {
+            std::fprintf(stderr, "verification failed for key 0x%016llx\n", static_cast<unsigned long long>(entry.key));
+            return 1;
+        }
+    }
+    CounterRng rng(7);
+    const int MISS_PROBES = 1 << 20;
+    int falsePositives = 0;
+    for (int i = 0; i < MISS_PROBES; ++i) {
+        const uint64_t key = static_cast<uint64_t>(rng()) << 32 | rng();
+        falsePositives += PolicyTable::probe(layout, key).has_value();
+    }
+
+    // 查询延迟：按随机顺序查询收录的键
+    std::vector<uint64_t> probeKeys(1 << 16);
+    for (uint64_t &key : probeKeys) {
+        key = entries[rng.below(static_cast<uint32_t>(entries.size()))].key;
+    }
+    const int PROBE_ROUNDS = 64;
+    uint64_t checksum = 0;
+    const auto probeStart = Clock::now();
+    for (int round = 0; round < PROBE_ROUNDS; ++round) {
+        for (uint64_t key : probeKeys) {
+            checksum += static_cast<uint64_t>(PolicyTable::probe(layout, key)->best);
+        }
+    }
+    const double probeNs = secondsSince(probeStart) * 1e9 / (PROBE_ROUNDS * probeKeys.size());
+
+    if (!writeTable(output, table, entries.size())) {
+        std::fprintf(stderr, "cannot write %s\n", output);
+        return 1;
+    }
+
+    const size_t bytes = PolicyTable::sizeBytes(layout);
+    std::printf("positions=%zu  solved_nodes=%llu  solve=%.2fs\n", entries.size(),
+                static_cast<unsigned long long>(solver.nodes()), solveSeconds);
+    std::printf("buckets=%zu  attempts=%d  build=%.3fs  blob=%zu bytes (%.1f bits/position)\n",
+                table.seeds.size(), attempts, buildSeconds, bytes, bytes * 8.0 / entries.size());
+    std::printf("probe=%.1f ns  false_positives=%d/%d  checksum=%llu\n", probeNs, falsePositives, MISS_PROBES,
+                static_cast<unsigned long long>(checksum));
+    std::printf("written to %s\n", output);
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "random.h"
+#include <cstdio>
+#include <vector>
+
+// CounterRng自检：从块内每个起始偏移（0到3）批量填充0到9个值，
+// 结果与之后的位置必须和逐个抽取完全一致；随后接着抽取的值也必须相同。
+// 全部通过返回0，否则逐项打印不一致之处并返回1。
+namespace {
+constexpr uint64_t SEED = 0x5eed;
+constexpr uint64_t STREAM = 3;
+constexpr int MAX_COUNT = 9;
+
+int checkU32(int offset, int count)
+{
+    CounterRng batch(SEED, STREAM);
+    CounterRng single(SEED, STREAM);
+    batch.discard(offset);
+    single.discard(offset);
+
+    std::vector<uint32_t> filled(count);
+    batch.fillU32(filled.data(), filled.size());
+    int failures = 0;
+    for (int i = 0; i < count; ++i) {
+        if (filled[i] != single()) {
+            std::fprintf(stderr, "fillU32 offset %d count %d: value %d differs\n", offset, count, i);
+            ++failures;
+        }
+    }
+    if (batch.position() != single.position() || batch() != single()) {
+        std::fprintf(stderr, "fillU32 offset %d count %d: stream position %llu, expected %llu\n", offset, count,
+                     static_cast<unsigned long long>(batch.position()),
+                     static_cast<unsigned long long>(single.position()));
+        ++failures;
+    }
+    return failures;
+}
+
+int checkUniform(int offset, int count)
+{
+    CounterRng batch(SEED, STREAM);
+    CounterRng single(SEED, STREAM);
+    batch.discard(offset);
+    single.discard(offset);
+
+    std::vector<double> filled(count);
+    batch.fillUniform(filled.data(), filled.size());
+    int failures = 0;
+    for (int i = 0; i < count; ++i) {
+        if (filled[i] != single.uniform()) {
+            std::fprintf(stderr, "fillUniform offset %d count %d: value %d differs\n", offset, count, i);
+            ++failures;
+        }
+    }
+    if (batch.position() != single.position() || batch.uniform() != single.uniform()) {
+        std::fprintf(stderr, "fillUniform offset %d count %d: stream position %llu, expected %llu\n", offset, count,
+                     static_cast<unsigned long long>(batch.position()),
+                     static_cast<unsigned long long>(single.position()));
+        ++failures;
+    }
+    return failures;
+}
+}
+
+int main()
+{
+    int failures = 0;
+    int cases = 0;
+    for (int offset = 0; offset < 4; ++offset) {
+        for (int count = 0; count <= MAX_COUNT; ++count) {
+            failures += checkU32(offset, count);
+            failures += checkUniform(offset, count);
+            cases += 2;
+        }
+    }
+    if (failures > 0) {
+        std::fprintf(stderr, "%d mismatches\n", failures);
+        return 1;
+    }
+    std::printf("%d fill cases match single draws\n", cases);
+    return 0;
+}
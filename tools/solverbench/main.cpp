@@ -0,0 +1,293 @@
+#include "gamemodel.h"
+#include "parallelsolver.h"
+#include "random.h"
+#include "solver.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+// 搜索引擎基准：对一组固定的带道具局面逐个查询（每次查询前clear），
+// 统计耗时、结点数，以及热身后每轮查询的堆分配次数（应为0）；
+// 再用1到N个线程分摊各局面根上的合法行动，比较各线程独立缓存与共享置换表时的扩展性；
+// 最后用ParallelSolver在工作窃取线程池上并行展开机会结点，报告相对单线程搜索的加速比与效率。
+namespace {
+using Clock = std::chrono::steady_clock;
+
+// 统计整个进程的operator new调用次数，用来核对内存区之外没有堆分配
+std::atomic<uint64_t> g_heapAllocations{0};
+
+struct Config {
+    int positions = 64;
+    int items = 2;  // 每方持有的道具件数
+    int rounds = 5; // 第一轮为热身
+    uint64_t seed = 1;
+    int threads = 0; // 0表示硬件线程数
+    int grain = ParallelSolver::DEFAULT_GRAIN;
+};
+
+struct ScalingResult {
+    double seconds;
+    uint64_t nodes;
+    uint64_t sharedHits;
+    bool matches;
+};
+
+double secondsSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// 局面集只由种子决定
+std::vector<Position> benchmarkPositions(const Config &config)
+{
+    CounterRng rng(config.seed);
+    std::vector<Position> positions;
+    positions.reserve(config.positions);
+    for (int i = 0; i < config.positions; ++i) {
+        Position position;
+        position.maxHealth = static_cast<uint8_t>(2 + rng.below(3));
+        position.health = {static_cast<uint8_t>(1 + rng.below(position.maxHealth)),
+                           static_cast<uint8_t>(1 + rng.below(position.maxHealth))};
+        position.live = static_cast<uint8_t>(1 + rng.below(4));
+        position.blank = static_cast<uint8_t>(1 + rng.below(4));
+        for (int side = 0; side < 2; ++side) {
+            for (int n = 0; n < config.items; ++n) {
+                uint8_t &count = position.items[side][rng.below(ITEM_KINDS)];
+                count = static_cast<uint8_t>(std::min<int>(count + 1, Position::MAX_ITEM_COUNT));
+            }
+        }
+        positions.push_back(position);
+    }
+    return positions;
+}
+
+// 1, 2, 4, ...，最后一项为maxThreads
+std::vector<int> threadCounts(int maxThreads)
+{
+    std::vector<int> counts;
+    for (int threads = 1; threads < maxThreads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(maxThreads);
+    return counts;
+}
+
+struct RootTask {
+    size_t position;
+    Action action;
+};
+
+std::vector<RootTask> rootTasks(const std::vector<Position> &positions)
+{
+    std::vector<RootTask> tasks;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        for (int a = 0; a < ACTION_KINDS; ++a) {
+            if (GameRules::isLegal(positions[i], static_cast<Action>(a))) {
+                tasks.push_back({i, static_cast<Action>(a)});
+            }
+        }
+    }
+    return tasks;
+}
+
+// threads个线程领取（局面，根行动）任务，每个任务前清空本地缓存；table非空时所有线程共享它。
+// 同一局面不同行动的子树大量重叠，独立缓存时各线程重复搜索，共享后只搜一次。
+ScalingResult runThreads(const std::vector<Position> &positions, const std::vector<double> &reference, int threads,
+                         TranspositionTable *table)
+{
+    const std::vector<RootTask> tasks = rootTasks(positions);
+    std::vector<double> values(tasks.size());
+    std::atomic<size_t> next{0};
+    std::atomic<uint64_t> nodes{0};
+    std::atomic<uint64_t> sharedHits{0};
+    const auto start = Clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            Solver solver(table);
+            for (size_t i = next++; i < tasks.size(); i = next++) {
+                solver.clear();
+                values[i] = solver.actionValue(positions[tasks[i].position], tasks[i].action);
+                nodes += solver.nodes();
+                sharedHits += solver.sharedHits();
+            }
+        });
+    }
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+    const double seconds = secondsSince(start);
+
+    std::vector<double> best(positions.size(), -1.0);
+    for (size_t i = 0; i < tasks.size(); ++i) {
+        best[tasks[i].position] = std::max(best[tasks[i].position], values[i]);
+    }
+    return {seconds, nodes.load(), sharedHits.load(), best == reference};
+}
+
+bool parseArguments(int argc, char *argv[], Config &config)
+{
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "missing value for %s\n", argv[i]);
+            return false;
+        }
+        const char *value = argv[i + 1];
+        if (std::strcmp(argv[i], "--positions") == 0) {
+            config.positions = std::max(1, std::atoi(value));
+        } else if (std::strcmp(argv[i], "--items") == 0) {
+            config.items = std::clamp(std::atoi(value), 0, 2 * Position::MAX_ITEM_COUNT);
+        } else if (std::strcmp(argv[i], "--rounds") == 0) {
+            config.rounds = std::max(2, std::atoi(value));
+        } else if (std::strcmp(argv[i], "--seed") == 0) {
+            config.seed = std::strtoull(value, nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0) {
+            config.threads = std::max(1, std::atoi(value));
+        } else if (std::strcmp(argv[i], "--grain") == 0) {
+            config.grain = std::max(0, std::atoi(value));
+        } else {
+            std::fprintf(stderr, "unknown option %s\n"
+                                 "usage: SolverBench [--positions N] [--items N] [--rounds N] [--seed N] [--threads N] [--grain N]\n", argv[i]);
+            return false;
+        }
+    }
+    return true;
+}
+}
+
+void *operator new(size_t size)
+{
+    g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+int main(int argc, char *argv[])
+{
+    Config config;
+    if (!parseArguments(argc, argv, config)) {
+        return 2;
+    }
+    const std::vector<Position> positions = benchmarkPositions(config);
+    std::printf("positions=%d  items=%d per side  rounds=%d  seed=%llu\n", config.positions, config.items,
+                config.rounds, static_cast<unsigned long long>(config.seed));
+
+    Solver solver;
+    std::vector<double> reference(positions.size());
+    for (int round = 0; round < config.rounds; ++round) {
+        const uint64_t heapBefore = g_heapAllocations.load();
+        const uint64_t blocksBefore = solver.memory().blockAllocations;
+        uint64_t nodes = 0;
+        size_t peakPositions = 0;
+        const auto start = Clock::now();
+        for (size_t i = 0; i < positions.size(); ++i) {
+            solver.clear();
+            const double value = solver.solve(positions[i]).value;
+            nodes += solver.nodes();
+            peakPositions = std::max(peakPositions, solver.cachedPositions());
+            if (round == 0) {
+                reference[i] = value;
+            } else if (value != reference[i]) {
+                std::fprintf(stderr, "position %zu: value changed between rounds\n", i);
+                return 1;
+            }
+        }
+        const double seconds = secondsSince(start);
+        std::printf("%-7s %2d  %8.3f ms/query  %10llu nodes  %6.2f Mnodes/s  peak %zu cached  "
+                    "heap allocations %llu  arena blocks +%llu\n",
+                    round == 0 ? "warm-up" : "round", round, seconds * 1000 / positions.size(),
+                    static_cast<unsigned long long>(nodes), nodes / std::max(1e-9, seconds) / 1e6, peakPositions,
+                    static_cast<unsigned long long>(g_heapAllocations.load() - heapBefore),
+                    static_cast<unsigned long long>(solver.memory().blockAllocations - blocksBefore));
+    }
+
+    solver.clear();
+    const SearchArena::Stats &memory = solver.memory();
+    std::printf("arena: %llu allocations, %.1f MiB reserved in %llu blocks, peak %.1f MiB per query\n",
+                static_cast<unsigned long long>(memory.allocations), memory.reservedBytes / 1048576.0,
+                static_cast<unsigned long long>(memory.blockAllocations), memory.highWaterBytes / 1048576.0);
+
+    // 扩展性：每个线程数都用新的置换表，只解一遍局面集；结点数与硬件无关，反映重复搜索的多少
+    const int maxThreads = config.threads > 0 ? config.threads : std::max(1u, std::thread::hardware_concurrency());
+    std::printf("\nthreads  %-44s  %-56s\n", "private caches", "shared transposition table");
+    double privateBase = 0.0;
+    double sharedBase = 0.0;
+    for (int threads : threadCounts(maxThreads)) {
+        const ScalingResult isolated = runThreads(positions, reference, threads, nullptr);
+        TranspositionTable table;
+        const ScalingResult shared = runThreads(positions, reference, threads, &table);
+        if (!isolated.matches || !shared.matches) {
+            std::fprintf(stderr, "%d threads: values differ from the single-threaded solve\n", threads);
+            return 1;
+        }
+        const double privateRate = positions.size() / isolated.seconds;
+        const double sharedRate = positions.size() / shared.seconds;
+        if (threads == 1) {
+            privateBase = privateRate;
+            sharedBase = sharedRate;
+        }
+        const double hitRate = static_cast<double>(shared.sharedHits) / std::max<uint64_t>(1, shared.sharedHits + shared.nodes);
+        std::printf("%7d  %8.1f q/s  x%5.2f  eff %3.0f%%  %9llu nodes    %8.1f q/s  x%5.2f  eff %3.0f%%  %9llu nodes  hits %4.1f%%\n",
+                    threads, privateRate, privateRate / privateBase, 100 * privateRate / privateBase / threads,
+                    static_cast<unsigned long long>(isolated.nodes), sharedRate, sharedRate / sharedBase,
+                    100 * sharedRate / sharedBase / threads, static_cast<unsigned long long>(shared.nodes), 100 * hitRate);
+    }
+
+    // 并行期望极大极小：基线是单线程Solver，两边都用新的置换表并在整个局面集上复用
+    double sequentialSeconds = 0.0;
+    {
+        TranspositionTable table;
+        Solver sequential(&table);
+        const auto start = Clock::now();
+        for (const Position &position : positions) {
+            sequential.clear();
+            sequential.solve(position);
+        }
+        sequentialSeconds = secondsSince(start);
+    }
+    std::printf("\nparallel expectimax (grain %d, sequential %.3f ms/query)\n", config.grain,
+                sequentialSeconds * 1000 / positions.size());
+    std::printf("threads  %10s  %8s  %5s  %10s  %9s  %8s\n", "ms/query", "speedup", "eff", "nodes", "tasks", "steals");
+    for (int threads : threadCounts(maxThreads)) {
+        TranspositionTable table;
+        ParallelSolver parallel(threads, &table);
+        parallel.setGrain(config.grain);
+        uint64_t nodes = 0;
+        uint64_t tasks = 0;
+        uint64_t steals = 0;
+        const auto start = Clock::now();
+        for (size_t i = 0; i < positions.size(); ++i) {
+            if (parallel.solve(positions[i]).value != reference[i]) {
+                std::fprintf(stderr, "%d threads: position %zu differs from the single-threaded solve\n", threads, i);
+                return 1;
+            }
+            nodes += parallel.nodes();
+            tasks += parallel.tasks();
+            steals += parallel.steals();
+        }
+        const double seconds = secondsSince(start);
+        const double speedup = sequentialSeconds / seconds;
+        std::printf("%7d  %10.3f  x%7.2f  %4.0f%%  %10llu  %9llu  %8llu\n", threads, seconds * 1000 / positions.size(),
+                    speedup, 100 * speedup / threads, static_cast<unsigned long long>(nodes),
+                    static_cast<unsigned long long>(tasks), static_cast<unsigned long long>(steals));
+    }
+    return 0;
+}
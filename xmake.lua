@@ -18,6 +18,9 @@ target("BuckshotRouletteTool")
     add_files("src/bullettypewidget.h")
     add_files("src/aisettings.h")
     add_files("src/aiclient.h")
+    add_files("src/aischeduler.h")
+    add_files("src/metricsdialog.h")
+    add_files("src/itemlistmodel.h")
     add_files("src/main.h")
     add_headerfiles("src/*.h")
     
@@ -26,6 +29,12 @@ target("BuckshotRouletteTool")
         add_cxflags("/utf-8")
     end
 
+    -- ShotTable在编译期求解并与参考实现逐项校验，放宽常量求值的步数上限
+    if is_plat("windows") then
+        add_cxflags("/constexpr:steps100000000")
+    end
+    add_cxflags("-fconstexpr-steps=100000000", {tools = {"clang", "clangxx"}})
+
 
     -- 构建后自动调用 windeployqt 部署 Qt 依赖
     after_build(function (target)
@@ -41,6 +50,96 @@ target("BuckshotRouletteTool")
         end
     end)
 
+-- 本地模拟的OpenAI兼容服务：xmake build MockAIServer && xmake run MockAIServer --help
+target("MockAIServer")
+    set_default(false)
+    set_languages("c++23")
+    add_rules("qt.console")
+    add_frameworks("QtCore", "QtNetwork")
+    add_files("tools/mockserver/*.cpp")
+    add_files("tools/mockserver/mockserver.h")
+    if is_plat("windows") then
+        add_cxflags("/utf-8")
+    end
+
+-- 驱动AIClient压测端点并输出延迟分布：xmake run AIClientHarness --stream --requests 100
+target("AIClientHarness")
+    set_default(false)
+    set_languages("c++23")
+    add_rules("qt.console")
+    add_frameworks("QtCore", "QtNetwork")
+    add_includedirs("src/")
+    add_files("tools/aiharness/main.cpp")
+    add_files("src/aiclient.cpp", "src/logger.cpp", "src/tracer.cpp")
+    add_files("src/aiclient.h")
+    if is_plat("windows") then
+        add_cxflags("/utf-8")
+    end
+
+-- 策略竞技场：各策略与庄家策略对战大量带种子的对局：xmake run PolicyArena --games 1000000 --items 2
+target("PolicyArena")
+    set_default(false)
+    set_kind("binary")
+    set_languages("c++23")
+    add_includedirs("src/")
+    add_files("tools/arena/main.cpp", "src/policies.cpp", "src/solver.cpp", "src/searcharena.cpp", "src/transpositiontable.cpp")
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
+    if is_plat("windows") then
+        add_cxflags("/utf-8")
+    end
+
+-- 求解常见局面并生成内嵌的完美哈希表（src/policytable.inc），修改对局模型或求解器后重新运行：
+-- xmake build PolicyTableGen && xmake run -w . PolicyTableGen --output src/policytable.inc
+target("PolicyTableGen")
+    set_default(false)
+    set_kind("binary")
+    set_languages("c++23")
+    add_includedirs("src/")
+    add_files("tools/policygen/main.cpp", "src/solver.cpp", "src/searcharena.cpp", "src/transpositiontable.cpp")
+    if is_plat("windows") then
+        add_cxflags("/utf-8")
+    end
+
+-- 批量核函数基准：xmake build KernelBench && xmake run KernelBench --states 4096
+target("KernelBench")
+    set_default(false)
+    set_kind("binary")
+    set_languages("c++23")
+    add_includedirs("src/")
+    add_files("tools/kernelbench/main.cpp", "src/batchkernels.cpp")
+    if is_plat("windows") then
+        add_cxflags("/utf-8")
+    end
+
+-- 随机数流自检：批量填充与逐个抽取必须逐位一致：xmake build RngCheck && xmake run RngCheck
+target("RngCheck")
+    set_default(false)
+    set_kind("binary")
+    set_languages("c++23")
+    add_includedirs("src/")
+    add_files("tools/rngcheck/main.cpp")
+    if is_plat("windows") then
+        add_cxflags("/utf-8")
+    end
+
+-- 搜索引擎基准：固定的带道具局面集，统计耗时、热身后的堆分配、1到N线程的扩展性与并行搜索的加速比：
+-- xmake run SolverBench --items 3 --threads 8
+target("SolverBench")
+    set_default(false)
+    set_kind("binary")
+    set_languages("c++23")
+    add_includedirs("src/")
+    add_files("tools/solverbench/main.cpp", "src/solver.cpp", "src/searcharena.cpp", "src/transpositiontable.cpp",
+              "src/parallelsolver.cpp", "src/workstealingpool.cpp")
+    if is_plat("linux") then
+        add_syslinks("pthread")
+    end
+    if is_plat("windows") then
+        add_cxflags("/utf-8")
+    end
+
 --
 -- If you want to known more usage about xmake, please see https://xmake.io
 --